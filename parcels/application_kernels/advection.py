@@ -5,7 +5,7 @@ from parcels.tools.statuscodes import OperationCode
 
 
 __all__ = ['AdvectionRK4', 'AdvectionEE', 'AdvectionRK45', 'AdvectionRK4_3D',
-           'AdvectionAnalytical']
+           'AdvectionRK4_IndexSpace', 'AdvectionAnalytical']
 
 
 def AdvectionRK4(particle, fieldset, time):
@@ -45,6 +45,20 @@ def AdvectionRK4_3D(particle, fieldset, time):
     particle.depth += (w1 + 2*w2 + 2*w3 + w4) / 6. * particle.dt
 
 
+def AdvectionRK4_IndexSpace(particle, fieldset, time):
+    """Advection of particles using fourth-order Runge-Kutta integration in the index space of the grid of U.
+
+    The particle position is kept as its cell index and its position in the cell (in particle.xi, particle.yi
+    and the Variables particle.xsi and particle.eta, which the particle class needs to define with dtype np.float64),
+    and the velocities are converted to index-space velocities through the Jacobian of the cell. This avoids the
+    index search (and on curvilinear grids the inverse bilinear map) of every field sample; particle.lon and
+    particle.lat are computed from the index-space position after every step.
+    Only works for 2D A-grid velocities (interp_method 'linear') with the default unit conversion of the mesh.
+
+    Function needs to be converted to Kernel object before execution"""
+    fieldset.UV.advect_index_space(time, particle)
+
+
 def AdvectionEE(particle, fieldset, time):
     """Advection of particles using Explicit Euler (aka Euler Forward) integration.
 
@@ -13,6 +13,7 @@ from parcels.particle import ScipyParticle, JITParticle  # noqa
 from parcels.field import Field
 from parcels.tools.loggers import logger
 from parcels.tools.statuscodes import OperationCode
+from parcels.tools.tracing import tracer
 
 try:
     from mpi4py import MPI
@@ -104,7 +105,8 @@ class ParticleCollectionAOS(ParticleCollection):
                             self._pu_indicators = kmeans.labels_
                         else:
                             self._pu_indicators = None
-                        self._pu_indicators = mpi_comm.bcast(self._pu_indicators, root=0)
+                        with tracer.span('MPI bcast', 'mpi'):
+                            self._pu_indicators = mpi_comm.bcast(self._pu_indicators, root=0)
                     elif np.max(self._pu_indicators) >= mpi_size:
                         raise RuntimeError('Particle partitions must vary between 0 and the number of mpi procs')
                     lon = lon[self._pu_indicators == mpi_rank]
@@ -114,7 +116,8 @@ class ParticleCollectionAOS(ParticleCollection):
                     pid = pid[self._pu_indicators == mpi_rank]
                     for kwvar in kwargs:
                         kwargs[kwvar] = kwargs[kwvar][self._pu_indicators == mpi_rank]
-                offset = MPI.COMM_WORLD.allreduce(offset, op=MPI.MAX)
+                with tracer.span('MPI allreduce', 'mpi'):
+                    offset = MPI.COMM_WORLD.allreduce(offset, op=MPI.MAX)
 
         pclass.setLastID(offset+1)
 
@@ -888,6 +891,13 @@ class ParticleCollectionAOS(ParticleCollection):
         cstruct = self._data_c.ctypes.data_as(c_void_p)
         return cstruct
 
+    def memory_usage(self):
+        """
+        'memory_usage' returns a dictionary of the bytes held by each particle variable in the array of C structs
+        (or, without JIT, the size of its values), which excludes the Python particle objects themselves
+        """
+        return {v.name: self._ncount * np.dtype(v.dtype).itemsize for v in self._ptype.variables}
+
     def toDictionary(self, pfile, time, deleted_only=False):
         """
         Convert all Particle data from one time step to a python dictionary.
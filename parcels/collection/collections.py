@@ -881,6 +881,14 @@ class ParticleCollection(Collection):
         """
         pass
 
+    @abstractmethod
+    def memory_usage(self):
+        """
+        'memory_usage' returns a dictionary of the bytes held by the storage of each particle variable. This depends
+        on the specific structure in question.
+        """
+        pass
+
     @abstractmethod
     def __getattr__(self, name):
         """
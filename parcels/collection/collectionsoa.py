@@ -9,10 +9,12 @@ import numpy as np
 from parcels.collection.collections import ParticleCollection
 from parcels.collection.iterators import BaseParticleAccessor
 from parcels.collection.iterators import BaseParticleCollectionIterator, BaseParticleCollectionIterable
-from parcels.particle import ScipyParticle, JITParticle  # noqa
+from parcels.particle import ScipyParticle, JITParticle, ColumnVariable  # noqa
 from parcels.field import Field
+from parcels.tools.allocation import concatenate_placed, delete_placed, empty_placed
 from parcels.tools.loggers import logger
 from parcels.tools.statuscodes import OperationCode
+from parcels.tools.tracing import tracer
 
 try:
     from mpi4py import MPI
@@ -106,7 +108,8 @@ class ParticleCollectionSOA(ParticleCollection):
                             self._pu_indicators = kmeans.labels_
                         else:
                             self._pu_indicators = None
-                        self._pu_indicators = mpi_comm.bcast(self._pu_indicators, root=0)
+                        with tracer.span('MPI bcast', 'mpi'):
+                            self._pu_indicators = mpi_comm.bcast(self._pu_indicators, root=0)
                     elif np.max(self._pu_indicators) >= mpi_size:
                         raise RuntimeError('Particle partitions must vary between 0 and the number of mpi procs')
                     lon = lon[self._pu_indicators == mpi_rank]
@@ -116,7 +119,8 @@ class ParticleCollectionSOA(ParticleCollection):
                     pid = pid[self._pu_indicators == mpi_rank]
                     for kwvar in kwargs:
                         kwargs[kwvar] = kwargs[kwvar][self._pu_indicators == mpi_rank]
-                offset = MPI.COMM_WORLD.allreduce(offset, op=MPI.MAX)
+                with tracer.span('MPI allreduce', 'mpi'):
+                    offset = MPI.COMM_WORLD.allreduce(offset, op=MPI.MAX)
 
         pclass.setLastID(offset+1)
 
@@ -137,9 +141,11 @@ class ParticleCollectionSOA(ParticleCollection):
 
         for v in self.ptype.variables:
             if v.name in ['xi', 'yi', 'zi', 'ti']:
-                self._data[v.name] = np.empty((len(lon), ngrid), dtype=v.dtype)
+                self._data[v.name] = empty_placed((len(lon), ngrid), dtype=v.dtype)
+            elif isinstance(v, ColumnVariable):
+                self._data[v.name] = empty_placed((len(lon), v.size), dtype=v.dtype)
             else:
-                self._data[v.name] = np.empty(self._ncount, dtype=v.dtype)
+                self._data[v.name] = empty_placed(self._ncount, dtype=v.dtype)
 
         if lon is not None and lat is not None:
             # Initialise from lists of lon/lat coordinates
@@ -435,14 +441,14 @@ class ParticleCollectionSOA(ParticleCollection):
         if self._sorted and same_class._sorted \
            and self._data['id'][0] > same_class._data['id'][-1]:
             for d in self._data:
-                self._data[d] = np.concatenate((same_class._data[d], self._data[d]))
+                self._data[d] = concatenate_placed((same_class._data[d], self._data[d]))
             self._ncount += same_class.ncount
         else:
             if not (same_class._sorted
                     and self._data['id'][-1] < same_class._data['id'][0]):
                 self._sorted = False
             for d in self._data:
-                self._data[d] = np.concatenate((self._data[d], same_class._data[d]))
+                self._data[d] = concatenate_placed((self._data[d], same_class._data[d]))
             self._ncount += same_class.ncount
 
     def __iadd__(self, same_class):
@@ -557,7 +563,7 @@ class ParticleCollectionSOA(ParticleCollection):
         super().remove_single_by_index(index)
 
         for d in self._data:
-            self._data[d] = np.delete(self._data[d], index, axis=0)
+            self._data[d] = delete_placed(self._data[d], index)
 
         self._ncount -= 1
 
@@ -643,9 +649,11 @@ class ParticleCollectionSOA(ParticleCollection):
         super().remove_multi_by_indices(indices)
         if type(indices) is dict:
             indices = list(indices.values())
+        if len(indices) == 0:
+            return
 
         for d in self._data:
-            self._data[d] = np.delete(self._data[d], indices, axis=0)
+            self._data[d] = delete_placed(self._data[d], indices)
 
         self._ncount -= len(indices)
 
@@ -814,6 +822,12 @@ class ParticleCollectionSOA(ParticleCollection):
         cstruct = CParticles(*cdata)
         return cstruct
 
+    def memory_usage(self):
+        """
+        'memory_usage' returns a dictionary of the bytes held by the array of each particle variable
+        """
+        return {name: data.nbytes for name, data in self._data.items()}
+
     def toDictionary(self, pfile, time, deleted_only=False):
         """
         Convert all Particle data from one time step to a python dictionary.
@@ -1,3 +1,5 @@
+import ctypes
+import ctypes.util
 import os
 import subprocess
 from struct import calcsize
@@ -7,6 +9,8 @@ try:
 except:
     MPI = None
 
+from parcels.tools.loggers import logger
+
 
 class Compiler_parameters(object):
     def __init__(self):
@@ -291,3 +295,127 @@ class GNUCompiler_SS(CCompiler_SS):
 
 
 GNUCompiler = GNUCompiler_SS
+
+
+def load_libtcc():
+    """Loads libtcc (the library of the Tiny C Compiler) from the path in the environment variable
+    ``PARCELS_LIBTCC`` or from the system library path; returns None if it is not available"""
+    if not hasattr(load_libtcc, 'lib'):
+        load_libtcc.lib = None
+        name = os.getenv('PARCELS_LIBTCC') or ctypes.util.find_library('tcc')
+        if name is not None:
+            try:
+                lib = ctypes.CDLL(name)
+            except OSError:
+                return None
+            lib.tcc_new.restype = ctypes.c_void_p
+            lib.tcc_delete.argtypes = [ctypes.c_void_p]
+            lib.tcc_set_output_type.argtypes = [ctypes.c_void_p, ctypes.c_int]
+            lib.tcc_set_error_func.argtypes = [ctypes.c_void_p, ctypes.c_void_p, TCCCompiler.error_func_type]
+            lib.tcc_add_include_path.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+            lib.tcc_define_symbol.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+            lib.tcc_add_library.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+            lib.tcc_compile_string.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+            # tcc_relocate(s, TCC_RELOCATE_AUTO) before tcc 0.9.28, tcc_relocate(s) after; the extra argument is ignored
+            lib.tcc_relocate.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+            lib.tcc_get_symbol.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+            lib.tcc_get_symbol.restype = ctypes.c_void_p
+            load_libtcc.lib = lib
+    return load_libtcc.lib
+
+
+class InMemoryLibrary(object):
+    """Code compiled into memory by the TCCCompiler, giving access to its functions (as attributes, like
+    a ctypes library) and global variables (through in_dll()) by name. error_func is the error callback
+    registered on the state, which is kept alive as long as the state"""
+
+    def __init__(self, libtcc, state, error_func=None):
+        self._libtcc = libtcc
+        self._state = state
+        self._error_func = error_func
+        self._functions = {}
+
+    def symbol(self, name):
+        address = self._libtcc.tcc_get_symbol(self._state, name.encode()) if self._state else None
+        if not address:
+            raise AttributeError("Symbol %s not found in the compiled code" % name)
+        return address
+
+    def __getattr__(self, name):
+        if name.startswith('_'):
+            raise AttributeError(name)
+        if name not in self._functions:
+            self._functions[name] = ctypes.CFUNCTYPE(ctypes.c_int)(self.symbol(name))
+        return self._functions[name]
+
+    def in_dll(self, ctype, name):
+        """The global variable name of the compiled code as an instance of ctype (cf. ctype.in_dll())"""
+        return ctype.from_address(self.symbol(name))
+
+    def close(self):
+        if self._state:
+            self._libtcc.tcc_delete(self._state)
+            self._state = None
+            self._error_func = None
+            self._functions = {}
+
+
+class TCCCompiler(object):
+    """An in-process compiler, which compiles the generated C code from memory with libtcc and returns
+    the compiled code as an InMemoryLibrary, without writing source, log or library files and without
+    spawning a compiler process. The code is not optimised as much as with gcc -O3, so this compiler is
+    meant for short runs and fast iteration on kernels.
+
+    :arg cppargs: A list of arguments to the C compiler; only definitions (-D) and include directories (-I) are used
+    :arg incdirs: A list of include directories
+    :arg fallback: Compiler used (by BaseKernel.compile) if the in-memory compilation fails"""
+    in_memory = True
+    error_func_type = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_char_p)
+
+    def __init__(self, cppargs=None, incdirs=None, fallback=None):
+        self._libtcc = load_libtcc()
+        if self._libtcc is None:
+            raise RuntimeError("libtcc not found; install the Tiny C Compiler or set PARCELS_LIBTCC to the path of libtcc")
+        self._cppargs = cppargs if cppargs is not None else []
+        self._incdirs = (incdirs if incdirs is not None else []) + [a[2:] for a in self._cppargs if a.startswith('-I')]
+        self._defines = [a[2:].split('=', 1) for a in self._cppargs if a.startswith('-D')]
+        self.fallback = fallback
+
+    def __str__(self):
+        return "[TCCCompiler]: ('cppargs': {}), ('incdirs': {})".format(self._cppargs, self._incdirs)
+
+    def compile_source(self, ccode):
+        """Compiles the C code string ccode into memory and returns it as an InMemoryLibrary"""
+        lib = self._libtcc
+        state = lib.tcc_new()
+        if not state:
+            raise RuntimeError("Could not create a libtcc compilation state")
+        errors = []
+        error_func = self.error_func_type(lambda opaque, msg: errors.append(msg.decode()))
+        lib.tcc_set_error_func(state, None, error_func)
+        lib.tcc_set_output_type(state, 1)  # TCC_OUTPUT_MEMORY
+        for incdir in self._incdirs:
+            lib.tcc_add_include_path(state, incdir.encode())
+        for define in self._defines:
+            lib.tcc_define_symbol(state, define[0].encode(), define[1].encode() if len(define) > 1 else b"1")
+        if lib.tcc_compile_string(state, ccode.encode()) != 0 or lib.tcc_add_library(state, b"m") != 0 \
+                or lib.tcc_relocate(state, ctypes.c_void_p(1)) < 0:  # TCC_RELOCATE_AUTO
+            lib.tcc_delete(state)
+            raise RuntimeError("Error during in-memory compilation:\n%s" % "\n".join(errors))
+        return InMemoryLibrary(lib, state, error_func)
+
+
+def get_jit_compiler(cppargs=None, incdirs=None):
+    """Compiler for the JIT kernels, chosen with the environment variable ``PARCELS_JIT_BACKEND``:
+    'gcc' (the default) for the GNUCompiler, or 'tcc' for the in-memory TCCCompiler, which falls back
+    to the GNUCompiler if libtcc is not available or cannot compile a kernel"""
+    gnu_compiler = GNUCompiler(cppargs=cppargs, incdirs=incdirs)
+    backend = os.getenv('PARCELS_JIT_BACKEND', 'gcc').lower()
+    if backend == 'gcc':
+        return gnu_compiler
+    elif backend != 'tcc':
+        raise ValueError("PARCELS_JIT_BACKEND should be 'gcc' or 'tcc', not '%s'" % backend)
+    if load_libtcc() is None:
+        logger.warning_once("libtcc not found, so kernels are compiled with %s instead of in memory" % gnu_compiler._cc)
+        return gnu_compiler
+    return TCCCompiler(cppargs=cppargs, incdirs=incdirs, fallback=gnu_compiler)
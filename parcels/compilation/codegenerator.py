@@ -14,6 +14,7 @@ from parcels.field import NestedField
 from parcels.field import SummedField
 from parcels.field import VectorField
 from parcels.grid import Grid
+from parcels.particle import ColumnVariable
 from parcels.particle import JITParticle
 from parcels.tools.loggers import logger
 
@@ -58,6 +59,8 @@ class FieldNode(IntrinsicNode):
                             ccode="%s->%s" % (self.ccode, attr))
         elif attr == "eval":
             return FieldEvalCallNode(self)
+        elif attr == "sample_column":
+            return FieldColumnCallNode(self)
         else:
             raise NotImplementedError('Access to Field attributes are not (yet) implemented in JIT mode')
 
@@ -77,11 +80,44 @@ class FieldEvalNode(IntrinsicNode):
         self.convert = convert  # whether to convert the result (like field.applyConversion)
 
 
+class FieldColumnCallNode(IntrinsicNode):
+    def __init__(self, field):
+        self.field = field
+        self.obj = field.obj
+        self.ccode = ""
+
+
+class FieldColumnNode(IntrinsicNode):
+    def __init__(self, field, time, variable):
+        self.field = field
+        self.time = time
+        self.variable = variable  # the ColumnVariable in which the profile is written
+
+
 class VectorFieldNode(IntrinsicNode):
+    def __getattr__(self, attr):
+        if attr == "advect_index_space":
+            return VectorFieldIndexSpaceCallNode(self)
+        else:
+            raise NotImplementedError('Access to VectorField attributes are not (yet) implemented in JIT mode')
+
     def __getitem__(self, attr):
         return VectorFieldEvalNode(self.obj, attr)
 
 
+class VectorFieldIndexSpaceCallNode(IntrinsicNode):
+    def __init__(self, field):
+        self.field = field
+        self.obj = field.obj
+        self.ccode = ""
+
+
+class VectorFieldIndexSpaceNode(IntrinsicNode):
+    def __init__(self, field, time):
+        self.field = field
+        self.time = time  # the time at the start of the step
+
+
 class VectorFieldEvalNode(IntrinsicNode):
     def __init__(self, field, args, var, var2, var3):
         self.field = field
@@ -206,6 +242,14 @@ class PrintNode(IntrinsicNode):
         self.obj = 'print'
 
 
+class ProfileSectionNode(ast.stmt):
+    """Statement that marks the start of a sub-kernel in the body of a profiled (merged) kernel"""
+    _fields = ()
+
+    def __init__(self, index):
+        self.index = index
+
+
 class GenericParticleAttributeNode(IntrinsicNode):
     def __init__(self, obj, attr, ccode=""):
         super(GenericParticleAttributeNode, self).__init__(obj, ccode)
@@ -410,6 +454,18 @@ class IntrinsicTransformer(ast.NodeTransformer):
             self.stmt_stack += [FieldEvalNode(node.func.field, args, tmp, convert)]
             return ast.Name(id=tmp)
 
+        elif isinstance(node.func, VectorFieldIndexSpaceCallNode):
+            node = VectorFieldIndexSpaceNode(node.func.field, node.args[0])
+
+        elif isinstance(node.func, FieldColumnCallNode):
+            # fieldset.F.sample_column(time, particle, 'name'), with name a ColumnVariable of the particle
+            name = node.args[2].s if len(node.args) == 3 and isinstance(node.args[2], ast.Str) else None
+            variable = next((v for v in self.ptype.variables if v.name == name), None)
+            if not isinstance(node.args[1], ParticleNode) or not isinstance(variable, ColumnVariable):
+                raise NotImplementedError("sample_column() should be called as sample_column(time, particle, 'name'), "
+                                          "with 'name' a ColumnVariable of the particle")
+            node = FieldColumnNode(node.func.field, node.args[0], variable)
+
         return node
 
 
@@ -576,6 +632,9 @@ class AbstractKernelGenerator(ABC, ast.NodeVisitor):
         self.visit(node.value)
         node.ccode = c.Statement(node.value.ccode)
 
+    def visit_ProfileSectionNode(self, node):
+        node.ccode = c.Statement("profile_section(%d)" % node.index)
+
     def visit_Assign(self, node):
         self.visit(node.targets[0])
         self.visit(node.value)
@@ -782,6 +841,18 @@ class AbstractKernelGenerator(ABC, ast.NodeVisitor):
     def visit_ConstNode(self, node):
         self.const_args[node.ccode] = node.obj
 
+    @staticmethod
+    def _boundary_resample(ccode_eval, args):
+        """Statements that take a failed field sample again at the position that the boundary policy moves it to,
+        when the kernel is called with the boundary policies in parcels_resample_policy (NULL otherwise) to repeat
+        a time step with resampling (see boundary_resample_step() in parcels.h).
+        ccode_eval gives the sampling call for a (time, depth, lat, lon) tuple"""
+        t, z, y, x = args
+        return [c.If("err == ERROR_OUT_OF_BOUNDS || err == ERROR_THROUGH_SURFACE",
+                     c.Block([c.Assign("double parcels_spos[3]", "{%s, %s, %s}" % (x, y, z)),
+                              c.If("boundary_sample_position(err, parcels_resample_policy, parcels_boundary_box, parcels_spos)",
+                                   c.Assign("err", ccode_eval(t, "parcels_spos[2]", "parcels_spos[1]", "parcels_spos[0]")))]))]
+
     @abstractmethod
     def visit_FieldEvalNode(self, node):
         pass
@@ -790,6 +861,14 @@ class AbstractKernelGenerator(ABC, ast.NodeVisitor):
     def visit_VectorFieldEvalNode(self, node):
         pass
 
+    @abstractmethod
+    def visit_VectorFieldIndexSpaceNode(self, node):
+        pass
+
+    @abstractmethod
+    def visit_FieldColumnNode(self, node):
+        pass
+
     @abstractmethod
     def visit_SummedFieldEvalNode(self, node):
         pass
@@ -864,7 +943,9 @@ class ArrayKernelGenerator(AbstractKernelGenerator):
         decl = c.Static(c.DeclSpecifier(c.Value("StatusCode", node.name), spec='inline'))
         args = [c.Pointer(c.Value(self.ptype.name + 'p', "particles")),
                 c.Value("int", "pnum"),
-                c.Value("double", "time")]
+                c.Value("double", "time"),
+                c.Pointer(c.Value("int", "parcels_resample_policy")),
+                c.Pointer(c.Value("double", "parcels_boundary_box"))]
         for field in self.field_args.values():
             args += [c.Pointer(c.Value("CField", "%s" % field.ccode_name))]
         for field in self.vector_field_args.values():
@@ -890,6 +971,7 @@ class ArrayKernelGenerator(AbstractKernelGenerator):
         args = self._check_FieldSamplingArguments(node.args.ccode)
         ccode_eval = node.field.obj.ccode_eval_array(node.var, *args)
         stmts = [c.Assign("err", ccode_eval)]
+        stmts += self._boundary_resample(lambda *a: node.field.obj.ccode_eval_array(node.var, *a), args)
 
         if node.convert:
             ccode_conv = node.field.obj.ccode_convert(*args)
@@ -902,8 +984,10 @@ class ArrayKernelGenerator(AbstractKernelGenerator):
         self.visit(node.field)
         self.visit(node.args)
         args = self._check_FieldSamplingArguments(node.args.ccode)
-        ccode_eval = node.field.obj.ccode_eval_array(node.var, node.var2, node.var3,
-                                                     node.field.obj.U, node.field.obj.V, node.field.obj.W, *args)
+
+        def ccode_eval(*a):
+            return node.field.obj.ccode_eval_array(node.var, node.var2, node.var3,
+                                                   node.field.obj.U, node.field.obj.V, node.field.obj.W, *a)
         if node.field.obj.U.interp_method != 'cgrid_velocity':
             ccode_conv1 = node.field.obj.U.ccode_convert(*args)
             ccode_conv2 = node.field.obj.V.ccode_convert(*args)
@@ -915,8 +999,44 @@ class ArrayKernelGenerator(AbstractKernelGenerator):
             ccode_conv3 = node.field.obj.W.ccode_convert(*args)
             statements.append(c.Statement("%s *= %s" % (node.var3, ccode_conv3)))
         conv_stat = c.Block(statements)
-        node.ccode = c.Block([c.Assign("err", ccode_eval),
-                              conv_stat, c.Statement("CHECKSTATUS(err)")])
+        node.ccode = c.Block([c.Assign("err", ccode_eval(*args))] + self._boundary_resample(ccode_eval, args)
+                             + [conv_stat, c.Statement("CHECKSTATUS(err)")])
+
+    def visit_VectorFieldIndexSpaceNode(self, node):
+        self.visit(node.field)
+        self.visit(node.time)
+        # the position is passed in doubles, whatever the precision of the particle coordinates
+        ccode_advect = node.field.obj.ccode_advect_index_space_array("parcels_lon", "parcels_lat", node.time.ccode)
+        node.ccode = str(c.Block([c.Initializer(c.Value("double", "parcels_lon"), "particles->lon[pnum]"),
+                                  c.Initializer(c.Value("double", "parcels_lat"), "particles->lat[pnum]"),
+                                  c.Assign("err", ccode_advect),
+                                  c.Assign("particles->lon[pnum]", "parcels_lon"),
+                                  c.Assign("particles->lat[pnum]", "parcels_lat"),
+                                  c.Statement("CHECKSTATUS(err)")]))
+
+    def visit_FieldColumnNode(self, node):
+        self.visit(node.field)
+        self.visit(node.time)
+        field, var = node.field.obj, node.variable
+        stmts = []
+        if var.depths is None:
+            if var.size != field.grid.zdim:
+                raise ValueError("ColumnVariable %s has size %d, but Field %s has %d depth levels"
+                                 % (var.name, var.size, field.name, field.grid.zdim))
+            depths = "NULL"
+        else:
+            depths = "parcels_column_depths"
+            stmts += [c.Initializer(c.ArrayOf(c.Value("double", depths), var.size),
+                                    "{%s}" % ", ".join(repr(float(d)) for d in var.depths))]
+        column = "particles->%s[pnum*%d+parcels_k]" % (var.name, var.size)
+        ccode_column = field.ccode_sample_column_array("&particles->%s[pnum*%d]" % (var.name, var.size), var.size,
+                                                       depths, node.time.ccode)
+        ccode_conv = field.ccode_convert(None, "particles->depth[pnum]", "particles->lat[pnum]", "particles->lon[pnum]")
+        stmts += [c.Assign("err", ccode_column),
+                  c.For("int parcels_k = 0", "parcels_k < %d" % var.size, "++parcels_k",
+                        c.Statement("%s *= %s" % (column, ccode_conv))),
+                  c.Statement("CHECKSTATUS(err)")]
+        node.ccode = str(c.Block(stmts))
 
     def visit_SummedFieldEvalNode(self, node):
         self.visit(node.fields)
@@ -1016,7 +1136,9 @@ class ObjectKernelGenerator(AbstractKernelGenerator):
         # Create function declaration and argument list
         decl = c.Static(c.DeclSpecifier(c.Value("StatusCode", node.name), spec='inline'))
         args = [c.Pointer(c.Value(self.ptype.name, "particle")),
-                c.Value("double", "time")]
+                c.Value("double", "time"),
+                c.Pointer(c.Value("int", "parcels_resample_policy")),
+                c.Pointer(c.Value("double", "parcels_boundary_box"))]
         for field in self.field_args.values():
             args += [c.Pointer(c.Value("CField", "%s" % field.ccode_name))]
         for field in self.vector_field_args.values():
@@ -1042,6 +1164,7 @@ class ObjectKernelGenerator(AbstractKernelGenerator):
         args = self._check_FieldSamplingArguments(node.args.ccode)
         ccode_eval = node.field.obj.ccode_eval_object(node.var, *args)
         stmts = [c.Assign("err", ccode_eval)]
+        stmts += self._boundary_resample(lambda *a: node.field.obj.ccode_eval_object(node.var, *a), args)
 
         if node.convert:
             ccode_conv = node.field.obj.ccode_convert(*args)
@@ -1054,7 +1177,10 @@ class ObjectKernelGenerator(AbstractKernelGenerator):
         self.visit(node.field)
         self.visit(node.args)
         args = self._check_FieldSamplingArguments(node.args.ccode)
-        ccode_eval = node.field.obj.ccode_eval_object(node.var, node.var2, node.var3, node.field.obj.U, node.field.obj.V, node.field.obj.W, *args)
+
+        def ccode_eval(*a):
+            return node.field.obj.ccode_eval_object(node.var, node.var2, node.var3,
+                                                    node.field.obj.U, node.field.obj.V, node.field.obj.W, *a)
         if node.field.obj.U.interp_method != 'cgrid_velocity':
             ccode_conv1 = node.field.obj.U.ccode_convert(*args)
             ccode_conv2 = node.field.obj.V.ccode_convert(*args)
@@ -1066,8 +1192,23 @@ class ObjectKernelGenerator(AbstractKernelGenerator):
             ccode_conv3 = node.field.obj.W.ccode_convert(*args)
             statements.append(c.Statement("%s *= %s" % (node.var3, ccode_conv3)))
         conv_stat = c.Block(statements)
-        node.ccode = c.Block([c.Assign("err", ccode_eval),
-                              conv_stat, c.Statement("CHECKSTATUS(err)")])
+        node.ccode = c.Block([c.Assign("err", ccode_eval(*args))] + self._boundary_resample(ccode_eval, args)
+                             + [conv_stat, c.Statement("CHECKSTATUS(err)")])
+
+    def visit_VectorFieldIndexSpaceNode(self, node):
+        self.visit(node.field)
+        self.visit(node.time)
+        # the position is passed in doubles, whatever the precision of the particle coordinates
+        ccode_advect = node.field.obj.ccode_advect_index_space_object("parcels_lon", "parcels_lat", node.time.ccode)
+        node.ccode = str(c.Block([c.Initializer(c.Value("double", "parcels_lon"), "particle->lon"),
+                                  c.Initializer(c.Value("double", "parcels_lat"), "particle->lat"),
+                                  c.Assign("err", ccode_advect),
+                                  c.Assign("particle->lon", "parcels_lon"),
+                                  c.Assign("particle->lat", "parcels_lat"),
+                                  c.Statement("CHECKSTATUS(err)")]))
+
+    def visit_FieldColumnNode(self, node):
+        raise NotImplementedError("ColumnVariables and Field.sample_column() are only implemented for SoA ParticleSets")
 
     def visit_SummedFieldEvalNode(self, node):
         self.visit(node.fields)
@@ -1141,13 +1282,85 @@ class ObjectKernelGenerator(AbstractKernelGenerator):
         node.ccode = c.While("1==1", c.Block(cstat))
 
 
+def profile_ccode(nsections):
+    """C code of the per-sub-kernel counters of a profiled kernel. profile_section(i) charges the clock ticks since
+    the previous call to the running sub-kernel and starts sub-kernel i; profile_close() charges the last one,
+    also when the kernel function returned early. The counters are read from Python with ctypes"""
+    return "\n".join(["uint64_t parcels_profile_cycles[%d] = {0};" % nsections,
+                      "uint64_t parcels_profile_calls[%d] = {0};" % nsections,
+                      "uint64_t parcels_profile_loop_cycles = 0;",
+                      "static int _profile_running = -1;",
+                      "static uint64_t _profile_t0 = 0;",
+                      "static inline void profile_section(int i)",
+                      "{",
+                      "  uint64_t t = profile_clock();",
+                      "  if (_profile_running >= 0)",
+                      "    parcels_profile_cycles[_profile_running] += t - _profile_t0;",
+                      "  _profile_running = i;",
+                      "  _profile_t0 = t;",
+                      "  parcels_profile_calls[i]++;",
+                      "}",
+                      "static inline void profile_close(void)",
+                      "{",
+                      "  if (_profile_running >= 0)",
+                      "    parcels_profile_cycles[_profile_running] += profile_clock() - _profile_t0;",
+                      "  _profile_running = -1;",
+                      "}"])
+
+
 class LoopGenerator(object):
     """Code generator class that adds type definitions and the outer
-    loop around kernel functions to generate compilable C code."""
+    loop around kernel functions to generate compilable C code.
+
+    :param prefetch_distance: Number of particles ahead for which the field cells at their cached
+           (xi, yi, zi, ti) indices are prefetched (0 disables software prefetching)
+    :param profile_sections: Number of sub-kernels for which clock ticks and calls are counted
+           (0 disables profiling, see profile_ccode())"""
 
-    def __init__(self, fieldset, ptype=None):
+    def __init__(self, fieldset, ptype=None, prefetch_distance=0, profile_sections=0):
         self.fieldset = fieldset
         self.ptype = ptype
+        self.prefetch_distance = prefetch_distance
+        self.profile_sections = profile_sections
+
+    @staticmethod
+    def boundary_resample_code(call, reset):
+        """Returns the statements that repeat a time step once, right after the kernel call, if it failed out of bounds
+        while the particle started inside the domain (see boundary_resample_step() in parcels.h). During that
+        repeat, field samples outside the domain are taken at the position that the boundary policy moves them to.
+        call gives the kernel call for the resample policy argument ('NULL' or 'boundary_policy'),
+        and reset the statements that restore the particle to the start of its time step"""
+        return [c.If("boundary_resample_step(res, boundary_policy, boundary_box, particle_backup.lon, particle_backup.lat, particle_backup.depth)",
+                     c.Block(reset + [c.Assign("res", call("boundary_policy"))]))]
+
+    @staticmethod
+    def boundary_policy_code():
+        """Returns the condition under which a failed time step is handed to apply_boundary_policy() (see
+        FieldSet.set_boundary_policy), and a function that generates that call for a particle accessor
+        format string (e.g. 'particles->%s[pnum]'). If the policy moved the particle back into the domain,
+        res is REPEAT and the step is repeated without leaving the loop; frozen particles skip to endtime"""
+        cond = "(res == ERROR_OUT_OF_BOUNDS || res == ERROR_THROUGH_SURFACE) && boundary_policy[res == ERROR_THROUGH_SURFACE] != BOUNDARY_RECOVER"
+
+        def policy_call(pvar):
+            return [c.Assign("double __bpos[3]", "{%s, %s, %s}" % tuple(pvar % v for v in ['lon', 'lat', 'depth'])),
+                    c.Assign("res", "apply_boundary_policy(res, boundary_policy, boundary_box, __bpos)"),
+                    c.Assign(pvar % 'lon', "__bpos[0]"),
+                    c.Assign(pvar % 'lat', "__bpos[1]"),
+                    c.Assign(pvar % 'depth', "__bpos[2]"),
+                    c.If("res == SUCCESS", c.Assign(pvar % 'time', "endtime"))]
+        return cond, policy_call
+
+    @staticmethod
+    def boundary_step_end_code(pvar):
+        """Returns the statements that apply boundary_step_end() of parcels.h to a particle that ended a successful
+        time step, for a particle accessor format string (e.g. 'particles->%s[pnum]'). A particle outside the domain
+        is moved into it, or res is set to the error that hands it to apply_boundary_policy() (delete or freeze)"""
+        return [c.If("res == SUCCESS && (boundary_policy[0] != BOUNDARY_RECOVER || boundary_policy[1] != BOUNDARY_RECOVER)",
+                     c.Block([c.Assign("double __bpos[3]", "{%s, %s, %s}" % tuple(pvar % v for v in ['lon', 'lat', 'depth'])),
+                              c.Assign("res", "boundary_step_end(boundary_policy, boundary_box, __bpos)"),
+                              c.Assign(pvar % 'lon', "__bpos[0]"),
+                              c.Assign(pvar % 'lat', "__bpos[1]"),
+                              c.Assign(pvar % 'depth', "__bpos[2]")]))]
 
     def generate(self, funcname, field_args, const_args, kernel_ast, c_include):
         ccode = []
@@ -1175,7 +1388,7 @@ class LoopGenerator(object):
                                                          spec='inline')), args)
         body = []
         for v in self.ptype.variables:
-            if v.dtype != np.uint64 and v.name not in ['dt', 'state']:
+            if v.dtype != np.uint64 and v.name not in ['dt', 'state'] and not isinstance(v, ColumnVariable):
                 body += [c.Assign(("particle_backup->%s" % v.name), ("particles->%s[pnum]" % v.name))]
         p_back_set_body = c.Block(body)
         p_back_set = str(c.FunctionBody(p_back_set_decl, p_back_set_body))
@@ -1188,7 +1401,7 @@ class LoopGenerator(object):
                                                          spec='inline')), args)
         body = []
         for v in self.ptype.variables:
-            if v.dtype != np.uint64 and v.name not in ['dt', 'state']:
+            if v.dtype != np.uint64 and v.name not in ['dt', 'state'] and not isinstance(v, ColumnVariable):
                 body += [c.Assign(("particles->%s[pnum]" % v.name), ("particle_backup->%s" % v.name))]
         p_back_get_body = c.Block(body)
         p_back_get = str(c.FunctionBody(p_back_get_decl, p_back_get_body))
@@ -1207,19 +1420,25 @@ class LoopGenerator(object):
         if c_include:
             ccode += [c_include]
 
+        if self.profile_sections > 0:
+            ccode += [profile_ccode(self.profile_sections)]
+
         # ==== Insert kernel code ==== #
         ccode += [str(kernel_ast)]
 
         # Generate outer loop for repeated kernel invocation
         args = [c.Value("int", "num_particles"),
                 c.Pointer(c.Value(pname, "particles")),
-                c.Value("double", "endtime"), c.Value("double", "dt")]
+                c.Value("double", "endtime"), c.Value("double", "dt"),
+                c.Pointer(c.Value("int", "boundary_policy")), c.Pointer(c.Value("double", "boundary_box"))]
         for field, _ in field_args.items():
             args += [c.Pointer(c.Value("CField", "%s" % field))]
         for const, _ in const_args.items():
             args += [c.Value("double", const)]  # are we SURE those const's are double's ?
-        fargs_str = ", ".join(['particles->time[pnum]'] + list(field_args.keys())
-                              + list(const_args.keys()))
+
+        def kernel_call(resample_policy):
+            fargs = ['particles->time[pnum]', resample_policy, 'boundary_box'] + list(field_args.keys()) + list(const_args.keys())
+            return "%s(particles, pnum, %s)" % (funcname, ", ".join(fargs))
         # ==== statement clusters use to compose 'body' variable and variables 'time_loop' and 'part_loop' ==== ##
         sign_dt = c.Assign("sign_dt", "dt > 0 ? 1 : -1")
         particle_backup = c.Statement("%s particle_backup" % self.ptype.name)
@@ -1248,14 +1467,27 @@ class LoopGenerator(object):
                                        c.Statement("continue")
                                    ]))
 
+        # ==== prefetch of the cells that particle pnum+prefetch_distance sampled last ==== #
+        prefetch = []
+        if self.prefetch_distance > 0:
+            ppf = "(pnum+%d)*ngrid+%%s->igrid" % self.prefetch_distance
+            prefetch = [c.If("pnum + %d < num_particles" % self.prefetch_distance,
+                             c.Block([c.Statement("prefetch_cell(%s, particles->xi[%s], particles->yi[%s], particles->zi[%s], particles->ti[%s])"
+                                                  % ((field,) + (ppf % field,) * 4)) for field in field_args.keys()]))]
+
         # ==== main computation body ==== #
+        boundary_cond, boundary_policy = self.boundary_policy_code()
         body = [c.Statement("set_particle_backup(&particle_backup, particles, pnum)")]
         body += [pdt_eq_dt_pos]
         body += [partdt]
         body += [c.Value("StatusCode", "state_prev"), c.Assign("state_prev", "particles->state[pnum]")]
-        body += [c.Assign("res", "%s(particles, pnum, %s)" % (funcname, fargs_str))]
+        body += [c.Assign("res", kernel_call("NULL"))]
+        body += self.boundary_resample_code(kernel_call, [c.Statement("get_particle_backup(&particle_backup, particles, pnum)"), partdt])
+        if self.profile_sections > 0:
+            body += [c.Statement("profile_close()")]
         body += [c.If("(res==SUCCESS) && (particles->state[pnum] != state_prev)", c.Assign("res", "particles->state[pnum]"))]
         body += [check_pdt]
+        body += self.boundary_step_end_code("particles->%s[pnum]")
         body += [c.If("res == SUCCESS || res == DELETE", c.Block([c.Statement("particles->time[pnum] += particles->dt[pnum]"),
                                                                   reset_dt,
                                                                   update_pdt,
@@ -1267,23 +1499,35 @@ class LoopGenerator(object):
                                                                   update_state,
                                                                   dt_0_break
                                                                   ]),
-                      c.Block([c.Statement("get_particle_backup(&particle_backup, particles, pnum)"),
-                               dt_pos,
-                               sign_end_part,
-                               c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
-                               update_state,
-                               c.Statement("break")])
+                      c.If(boundary_cond,
+                           c.Block([c.Statement("get_particle_backup(&particle_backup, particles, pnum)")]
+                                   + boundary_policy("particles->%s[pnum]")
+                                   + [dt_pos,
+                                      sign_end_part,
+                                      c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
+                                      update_state,
+                                      c.If("res != REPEAT", c.Statement("break"))]),
+                           c.Block([c.Statement("get_particle_backup(&particle_backup, particles, pnum)"),
+                                    dt_pos,
+                                    sign_end_part,
+                                    c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
+                                    update_state,
+                                    c.Statement("break")]))
                       )]
 
         time_loop = c.While("(particles->state[pnum] == EVALUATE || particles->state[pnum] == REPEAT) || is_zero_dbl(particles->dt[pnum])", c.Block(body))
         part_loop = c.For("pnum = 0", "pnum < num_particles", "++pnum",
-                          c.Block([sign_end_part, reset_res_state, dt_pos, notstarted_continue, time_loop]))
-        fbody = c.Block([c.Value("int", "pnum, sign_dt, sign_end_part"),
-                         c.Value("StatusCode", "res"),
-                         c.Value("double", "reset_dt"),
-                         c.Value("double", "__pdt_prekernels"),
-                         c.Value("double", "__dt"),  # 1e-8 = built-in tolerance for np.isclose()
-                         sign_dt, particle_backup, part_loop])
+                          c.Block(prefetch + [sign_end_part, reset_res_state, dt_pos, notstarted_continue, time_loop]))
+        fbody = [c.Value("int", "pnum, sign_dt, sign_end_part"),
+                 c.Value("StatusCode", "res"),
+                 c.Value("double", "reset_dt"),
+                 c.Value("double", "__pdt_prekernels"),
+                 c.Value("double", "__dt"),  # 1e-8 = built-in tolerance for np.isclose()
+                 sign_dt, particle_backup, part_loop]
+        if self.profile_sections > 0:
+            fbody.insert(0, c.Assign("uint64_t __profile_start", "profile_clock()"))
+            fbody += [c.Statement("parcels_profile_loop_cycles += profile_clock() - __profile_start")]
+        fbody = c.Block(fbody)
         fdecl = c.FunctionDeclaration(c.Value("void", "particle_loop"), args)
         ccode += [str(c.FunctionBody(fdecl, fbody))]
         return "\n\n".join(ccode)
@@ -1291,11 +1535,15 @@ class LoopGenerator(object):
 
 class ParticleObjectLoopGenerator(object):
     """Code generator class that adds type definitions and the outer
-    loop around kernel functions to generate compilable C code."""
+    loop around kernel functions to generate compilable C code.
 
-    def __init__(self, fieldset=None, ptype=None):
+    :param profile_sections: Number of sub-kernels for which clock ticks and calls are counted
+           (0 disables profiling, see profile_ccode())"""
+
+    def __init__(self, fieldset=None, ptype=None, profile_sections=0):
         self.fieldset = fieldset
         self.ptype = ptype
+        self.profile_sections = profile_sections
 
     def generate(self, funcname, field_args, const_args, kernel_ast, c_include):
         ccode = []
@@ -1354,6 +1602,9 @@ class ParticleObjectLoopGenerator(object):
         if c_include:
             ccode += [c_include]
 
+        if self.profile_sections > 0:
+            ccode += [profile_ccode(self.profile_sections)]
+
         # ==== Insert kernel code ==== #
         ccode += [str(kernel_ast)]
 
@@ -1361,14 +1612,18 @@ class ParticleObjectLoopGenerator(object):
         args = [c.Value("int", "num_particles"),
                 c.Pointer(c.Value(self.ptype.name, "particles")),
                 c.Value("double", "endtime"),
-                c.Value("double", "dt")
+                c.Value("double", "dt"),
+                c.Pointer(c.Value("int", "boundary_policy")),
+                c.Pointer(c.Value("double", "boundary_box"))
                 ]
         for field, _ in field_args.items():
             args += [c.Pointer(c.Value("CField", "%s" % field))]
         for const, _ in const_args.items():
             args += [c.Value("double", const)]  # are we SURE those const's are double's ?
-        fargs_str = ", ".join(['particles[p].time'] + list(field_args.keys())
-                              + list(const_args.keys()))
+
+        def kernel_call(resample_policy):
+            fargs = ['particles[p].time', resample_policy, 'boundary_box'] + list(field_args.keys()) + list(const_args.keys())
+            return "%s(&(particles[p]), %s)" % (funcname, ", ".join(fargs))
         # ==== statement clusters use to compose 'body' variable and variables 'time_loop' and 'part_loop' ==== ##
         sign_dt = c.Assign("sign_dt", "dt > 0 ? 1 : -1")
         particle_backup = c.Statement("%s particle_backup" % self.ptype.name)
@@ -1398,13 +1653,18 @@ class ParticleObjectLoopGenerator(object):
                                    ]))
 
         # ==== main computation body ==== #
+        boundary_cond, boundary_policy = LoopGenerator.boundary_policy_code()
         body = [c.Statement("set_particle_backup(&particle_backup, &(particles[p]))")]
         body += [pdt_eq_dt_pos]
         body += [partdt]
         body += [c.Value("StatusCode", "state_prev"), c.Assign("state_prev", "particles[p].state")]
-        body += [c.Assign("res", "%s(&(particles[p]), %s)" % (funcname, fargs_str))]
+        body += [c.Assign("res", kernel_call("NULL"))]
+        body += LoopGenerator.boundary_resample_code(kernel_call, [c.Statement("get_particle_backup(&particle_backup, &(particles[p]))"), partdt])
+        if self.profile_sections > 0:
+            body += [c.Statement("profile_close()")]
         body += [c.If("(res == SUCCESS) && (particles[p].state != state_prev)", c.Assign("res", "particles[p].state"))]
         body += [check_pdt]
+        body += LoopGenerator.boundary_step_end_code("particles[p].%s")
         body += [c.If("res == SUCCESS || res == DELETE", c.Block([c.Statement("particles[p].time += particles[p].dt"),
                                                                   reset_dt,
                                                                   update_pdt,
@@ -1416,23 +1676,35 @@ class ParticleObjectLoopGenerator(object):
                                                                   update_state,
                                                                   dt_0_break
                                                                   ]),
-                      c.Block([c.Statement("get_particle_backup(&particle_backup, &(particles[p]))"),
-                               dt_pos,
-                               sign_end_part,
-                               c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
-                               update_state,
-                               c.Statement("break")])
+                      c.If(boundary_cond,
+                           c.Block([c.Statement("get_particle_backup(&particle_backup, &(particles[p]))")]
+                                   + boundary_policy("particles[p].%s")
+                                   + [dt_pos,
+                                      sign_end_part,
+                                      c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
+                                      update_state,
+                                      c.If("res != REPEAT", c.Statement("break"))]),
+                           c.Block([c.Statement("get_particle_backup(&particle_backup, &(particles[p]))"),
+                                    dt_pos,
+                                    sign_end_part,
+                                    c.If("sign_dt != sign_end_part", c.Assign("__dt", "0")),
+                                    update_state,
+                                    c.Statement("break")]))
                       )]
 
         time_loop = c.While("(particles[p].state == EVALUATE || particles[p].state == REPEAT) || is_zero_dbl(particles[p].dt)", c.Block(body))
         part_loop = c.For("p = 0", "p < num_particles", "++p",
                           c.Block([sign_end_part, reset_res_state, dt_pos, notstarted_continue, time_loop]))
-        fbody = c.Block([c.Value("int", "p, sign_dt, sign_end_part"),
-                         c.Value("StatusCode", "res"),
-                         c.Value("int", "reset_dt"),
-                         c.Value("double", "__pdt_prekernels"),
-                         c.Value("double", "__dt"),  # 1e-8 = built-in tolerance for np.isclose()
-                         sign_dt, particle_backup, part_loop])
+        fbody = [c.Value("int", "p, sign_dt, sign_end_part"),
+                 c.Value("StatusCode", "res"),
+                 c.Value("int", "reset_dt"),
+                 c.Value("double", "__pdt_prekernels"),
+                 c.Value("double", "__dt"),  # 1e-8 = built-in tolerance for np.isclose()
+                 sign_dt, particle_backup, part_loop]
+        if self.profile_sections > 0:
+            fbody.insert(0, c.Assign("uint64_t __profile_start", "profile_clock()"))
+            fbody += [c.Statement("parcels_profile_loop_cycles += profile_clock() - __profile_start")]
+        fbody = c.Block(fbody)
         fdecl = c.FunctionDeclaration(c.Value("void", "particle_loop"), args)
         ccode += [str(c.FunctionBody(fdecl, fbody))]
         return "\n\n".join(ccode)
@@ -1,5 +1,6 @@
 import collections
 import datetime
+import itertools
 import math
 from ctypes import c_float
 from ctypes import c_int
@@ -14,12 +15,13 @@ from pathlib import Path
 
 import parcels.tools.interpolation_utils as i_u
 from .fieldfilebuffer import (NetcdfFileBuffer, DeferredNetcdfFileBuffer,
-                              DaskFileBuffer, DeferredDaskFileBuffer)
+                              DaskFileBuffer, DeferredDaskFileBuffer,
+                              ZarrFileBuffer, DeferredZarrFileBuffer, SharedMemoryFileBuffer)
 from .grid import CGrid
 from .grid import Grid
 from .grid import GridCode
-from parcels.tools.converters import Geographic
-from parcels.tools.converters import GeographicPolar
+from parcels.tools.allocation import array_placed
+from parcels.tools.ingest import ingest
 from parcels.tools.converters import TimeConverter
 from parcels.tools.converters import UnitConverter
 from parcels.tools.converters import unitconverters_map
@@ -28,6 +30,7 @@ from parcels.tools.statuscodes import FieldOutOfBoundSurfaceError
 from parcels.tools.statuscodes import FieldSamplingError
 from parcels.tools.statuscodes import TimeExtrapolationError
 from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
 
 
 __all__ = ['Field', 'VectorField', 'SummedField', 'NestedField']
@@ -161,17 +164,14 @@ class Field(object):
 
             # Hack around the fact that NaN and ridiculously large values
             # propagate in SciPy's interpolators
-            lib = np if isinstance(self.data, np.ndarray) else da
-            self.data[lib.isnan(self.data)] = 0.
-            if self.vmin is not None:
-                self.data[self.data < self.vmin] = 0.
-            if self.vmax is not None:
-                self.data[self.data > self.vmax] = 0.
+            self.data = ingest(self.data, vmin=self.vmin, vmax=self.vmax, inplace=True)
 
+            lib = np if isinstance(self.data, np.ndarray) else da
             if self.grid._add_last_periodic_data_timestep:
                 self.data = lib.concatenate((self.data, self.data[:1, :]), axis=0)
 
         self._scaling_factor = None
+        self.keepbits = None
 
         # Variable names in JIT code
         self.dimensions = kwargs.pop('dimensions', None)
@@ -198,7 +198,11 @@ class Field(object):
         self.c_data_chunks = []
         self.nchunks = []
         self.chunk_set = False
+        self._chunked_view = None
+        self.chunk_compressor = None  # ChunkCompressor of cold blocks (see FieldSet.set_chunk_compression())
+        self.compressed_chunks = {}  # compressed copies of blocks of the loaded time slices, by block id
         self.filebuffers = [None] * 2
+        self._ingested_slots = {}  # slice in each ring slot that has been post-processed, for shared memory fields
         if len(kwargs) > 0:
             raise SyntaxError('Field received an unexpected keyword argument "%s"' % list(kwargs.keys())[0])
 
@@ -282,7 +286,8 @@ class Field(object):
                deferred_load=False is however sometimes necessary for plotting the fields.
         :param gridindexingtype: The type of gridindexing. Either 'nemo' (default) or 'mitgcm' are supported.
                See also the Grid indexing documentation on oceanparcels.org
-        :param chunksize: size of the chunks in dask loading
+        :param chunksize: size of the chunks in dask loading, or 'native' for the chunks of a Zarr store
+               (with netcdf_engine='zarr'), so that each block that Parcels loads is one chunk of the store
 
         For usage examples see the following tutorial:
 
@@ -339,7 +344,7 @@ class Field(object):
 
         _grid_fb_class = NetcdfFileBuffer
 
-        with _grid_fb_class(lonlat_filename, dimensions, indices, netcdf_engine) as filebuffer:
+        with _grid_fb_class(lonlat_filename, dimensions, indices, netcdf_engine=netcdf_engine) as filebuffer:
             lon, lat = filebuffer.lonlat
             indices = filebuffer.indices
             # Check if parcels_mesh has been explicitly set in file
@@ -347,7 +352,7 @@ class Field(object):
                 mesh = filebuffer.dataset.attrs['parcels_mesh']
 
         if 'depth' in dimensions:
-            with _grid_fb_class(depth_filename, dimensions, indices, netcdf_engine, interp_method=interp_method) as filebuffer:
+            with _grid_fb_class(depth_filename, dimensions, indices, netcdf_engine=netcdf_engine, interp_method=interp_method) as filebuffer:
                 filebuffer.name = filebuffer.parse_name(variable[1])
                 if dimensions['depth'] == 'not_yet_set':
                     depth = filebuffer.depth_dimensions
@@ -393,7 +398,14 @@ class Field(object):
         if grid.time.size <= 2 or deferred_load is False:
             deferred_load = False
 
-        if chunksize not in [False, None]:
+        if chunksize == 'native':
+            if netcdf_engine != 'zarr':
+                raise NotImplementedError("chunksize='native' is only implemented for Zarr stores (netcdf_engine='zarr')")
+            if deferred_load:
+                _field_fb_class = DeferredZarrFileBuffer
+            else:
+                _field_fb_class = ZarrFileBuffer
+        elif chunksize not in [False, None]:
             if deferred_load:
                 _field_fb_class = DeferredDaskFileBuffer
             else:
@@ -409,7 +421,7 @@ class Field(object):
             data_list = []
             ti = 0
             for tslice, fname in zip(grid.timeslices, data_filenames):
-                with _field_fb_class(fname, dimensions, indices, netcdf_engine,
+                with _field_fb_class(fname, dimensions, indices, netcdf_engine=netcdf_engine,
                                      interp_method=interp_method, data_full_zdim=data_full_zdim,
                                      chunksize=chunksize) as filebuffer:
                     # If Field.from_netcdf is called directly, it may not have a 'data' dimension
@@ -485,6 +497,51 @@ class Field(object):
         return cls(name, data, grid=grid, allow_time_extrapolation=allow_time_extrapolation,
                    interp_method=interp_method, **kwargs)
 
+    @classmethod
+    def from_shared_memory(cls, ringname, variable, grid=None, timeout=None, **kwargs):
+        """Create field from the time slices that a running model publishes in a
+        :class:`parcels.tools.sharedmemory.SharedMemoryRing`. The grid (coordinates, mesh and the times of
+        all slices) is read from the ring. The Field is in deferred_load mode, and its data is a view of the ring
+        slots of the two loaded time slices, so that FieldSet.computeTimeChunk() does not copy the data but
+        blocks until the producer has published the slices it needs. Only forward execution is supported.
+
+        :param ringname: Name of the shared memory block of the ring
+        :param variable: Tuple mapping field name to variable name in the ring (or the name of both)
+        :param grid: Optional grid to share with another Field of the same ring
+        :param timeout: Maximum number of seconds to wait for a slice (default: no limit)
+        """
+        variable = variable if isinstance(variable, tuple) else (variable, variable)
+        filebuffer = SharedMemoryFileBuffer(ringname, {}, {}, timeout=timeout).__enter__()
+        try:
+            filebuffer.name = filebuffer.parse_name(variable[1])
+            if grid is None:
+                lon, lat = filebuffer.lonlat
+                grid = Grid.create_grid(lon, lat, filebuffer.depth, filebuffer.time, time_origin=TimeConverter(0),
+                                        mesh=filebuffer.mesh)
+            grid.defer_load = True
+            grid.ti = -1
+            data = DeferredArray()
+            data.compute_shape(grid.xdim, grid.ydim, grid.zdim, grid.tdim, len(filebuffer.time))
+            kwargs['dataFiles'] = np.array([ringname] * len(filebuffer.time))
+            kwargs['FieldFileBuffer'] = SharedMemoryFileBuffer
+            field = cls(variable, data, grid=grid, allow_time_extrapolation=False, **kwargs)
+        except Exception:
+            filebuffer.close()
+            raise
+        field.filebuffers[0] = filebuffer
+        return field
+
+    def close(self):
+        """Closes the file buffers that the Field holds open, e.g. its attachment to the SharedMemoryRing
+        of a Field from Field.from_shared_memory(). Also called when the Field is released"""
+        for i, filebuffer in enumerate(getattr(self, 'filebuffers', [])):
+            if filebuffer is not None:
+                filebuffer.close()
+                self.filebuffers[i] = None
+
+    def __del__(self):
+        self.close()
+
     def reshape(self, data, transpose=False):
         # Ensure that field data is the right data type
         if not isinstance(data, (np.ndarray, da.core.Array)):
@@ -549,6 +606,19 @@ class Field(object):
         if not self.grid.defer_load:
             self.data *= factor
 
+    def set_keepbits(self, keepbits):
+        """Rounds the field data to keepbits bits of the float32 mantissa (out of 23) when it is loaded,
+        which makes the data compress better, at a relative precision of 2**-(keepbits+1).
+        Data that is already loaded is rounded into a copy, so that the array the Field was created from is left intact
+
+        :param keepbits: number of mantissa bits to keep, or None to keep the full precision
+        """
+        if keepbits is not None and not 0 <= keepbits <= 23:
+            raise ValueError('keepbits should be between 0 and 23')
+        self.keepbits = keepbits
+        if not self.grid.defer_load and keepbits is not None:
+            self.data = ingest(self.data, keepbits=keepbits)
+
     def set_depth_from_field(self, field):
         """Define the depth dimensions from another (time-varying) field
 
@@ -561,32 +631,13 @@ class Field(object):
             field.grid.depth_field = field
 
     def calc_cell_edge_sizes(self):
-        """Method to calculate cell sizes based on numpy.gradient method
-                Currently only works for Rectilinear Grids"""
-        if not self.grid.cell_edge_sizes:
-            if self.grid.gtype in (GridCode.RectilinearZGrid, GridCode.RectilinearSGrid):
-                self.grid.cell_edge_sizes['x'] = np.zeros((self.grid.ydim, self.grid.xdim), dtype=np.float32)
-                self.grid.cell_edge_sizes['y'] = np.zeros((self.grid.ydim, self.grid.xdim), dtype=np.float32)
-
-                x_conv = GeographicPolar() if self.grid.mesh == 'spherical' else UnitConverter()
-                y_conv = Geographic() if self.grid.mesh == 'spherical' else UnitConverter()
-                for y, (lat, dy) in enumerate(zip(self.grid.lat, np.gradient(self.grid.lat))):
-                    for x, (lon, dx) in enumerate(zip(self.grid.lon, np.gradient(self.grid.lon))):
-                        self.grid.cell_edge_sizes['x'][y, x] = x_conv.to_source(dx, lon, lat, self.grid.depth[0])
-                        self.grid.cell_edge_sizes['y'][y, x] = y_conv.to_source(dy, lon, lat, self.grid.depth[0])
-                self.cell_edge_sizes = self.grid.cell_edge_sizes
-            else:
-                logger.error(('Field.cell_edge_sizes() not implemented for ', self.grid.gtype, 'grids.',
-                              'You can provide Field.grid.cell_edge_sizes yourself',
-                              'by in e.g. NEMO using the e1u fields etc from the mesh_mask.nc file'))
-                exit(-1)
+        """Method to calculate cell sizes based on numpy.gradient method, for all grid types.
+        See Grid.calc_cell_edge_sizes; the result is cached on the Grid"""
+        self.cell_edge_sizes = self.grid.calc_cell_edge_sizes()
 
     def cell_areas(self):
-        """Method to calculate cell sizes based on cell_edge_sizes
-                Currently only works for Rectilinear Grids"""
-        if not self.grid.cell_edge_sizes:
-            self.calc_cell_edge_sizes()
-        return self.grid.cell_edge_sizes['x'] * self.grid.cell_edge_sizes['y']
+        """Method to calculate cell sizes based on cell_edge_sizes"""
+        return self.grid.cell_areas()
 
     def search_indices_vertical_z(self, z):
         grid = self.grid
@@ -877,18 +928,19 @@ class Field(object):
 
     def interpolator2D(self, ti, z, y, x, particle=None):
         (xsi, eta, _, xi, yi, _) = self.search_indices(x, y, z, particle=particle)
+        data = self.interpolation_data
         if self.interp_method == 'nearest':
             xii = xi if xsi <= .5 else xi+1
             yii = yi if eta <= .5 else yi+1
-            return self.data[ti, yii, xii]
+            return data[ti, yii, xii]
         elif self.interp_method in ['linear', 'bgrid_velocity']:
-            val = (1-xsi)*(1-eta) * self.data[ti, yi, xi] + \
-                xsi*(1-eta) * self.data[ti, yi, xi+1] + \
-                xsi*eta * self.data[ti, yi+1, xi+1] + \
-                (1-xsi)*eta * self.data[ti, yi+1, xi]
+            val = (1-xsi)*(1-eta) * data[ti, yi, xi] + \
+                xsi*(1-eta) * data[ti, yi, xi+1] + \
+                xsi*eta * data[ti, yi+1, xi+1] + \
+                (1-xsi)*eta * data[ti, yi+1, xi]
             return val
         elif self.interp_method == 'linear_invdist_land_tracer':
-            land = np.isclose(self.data[ti, yi:yi+2, xi:xi+2], 0.)
+            land = np.isclose(data[ti, yi:yi+2, xi:xi+2], 0.)
             nb_land = np.sum(land)
             if nb_land == 4:
                 return 0
@@ -902,19 +954,19 @@ class Field(object):
                             if land[j][i] == 1:  # index search led us directly onto land
                                 return 0
                             else:
-                                return self.data[ti, yi+j, xi+i]
+                                return data[ti, yi+j, xi+i]
                         elif land[i][j] == 0:
-                            val += self.data[ti, yi+j, xi+i] / distance
+                            val += data[ti, yi+j, xi+i] / distance
                             w_sum += 1 / distance
                 return val / w_sum
             else:
-                val = (1 - xsi) * (1 - eta) * self.data[ti, yi, xi] + \
-                    xsi * (1 - eta) * self.data[ti, yi, xi + 1] + \
-                    xsi * eta * self.data[ti, yi + 1, xi + 1] + \
-                    (1 - xsi) * eta * self.data[ti, yi + 1, xi]
+                val = (1 - xsi) * (1 - eta) * data[ti, yi, xi] + \
+                    xsi * (1 - eta) * data[ti, yi, xi + 1] + \
+                    xsi * eta * data[ti, yi + 1, xi + 1] + \
+                    (1 - xsi) * eta * data[ti, yi + 1, xi]
                 return val
         elif self.interp_method in ['cgrid_tracer', 'bgrid_tracer']:
-            return self.data[ti, yi+1, xi+1]
+            return data[ti, yi+1, xi+1]
         elif self.interp_method == 'cgrid_velocity':
             raise RuntimeError("%s is a scalar field. cgrid_velocity interpolation method should be used for vector fields (e.g. FieldSet.UV)" % self.name)
         else:
@@ -922,22 +974,23 @@ class Field(object):
 
     def interpolator3D(self, ti, z, y, x, time, particle=None):
         (xsi, eta, zeta, xi, yi, zi) = self.search_indices(x, y, z, ti, time, particle=particle)
+        fdata = self.interpolation_data
         if self.interp_method == 'nearest':
             xii = xi if xsi <= .5 else xi+1
             yii = yi if eta <= .5 else yi+1
             zii = zi if zeta <= .5 else zi+1
-            return self.data[ti, zii, yii, xii]
+            return fdata[ti, zii, yii, xii]
         elif self.interp_method == 'cgrid_velocity':
             # evaluating W velocity in c_grid
             if self.gridindexingtype == 'nemo':
-                f0 = self.data[ti, zi, yi+1, xi+1]
-                f1 = self.data[ti, zi+1, yi+1, xi+1]
+                f0 = fdata[ti, zi, yi+1, xi+1]
+                f1 = fdata[ti, zi+1, yi+1, xi+1]
             elif self.gridindexingtype == 'mitgcm':
-                f0 = self.data[ti, zi, yi, xi]
-                f1 = self.data[ti, zi+1, yi, xi]
+                f0 = fdata[ti, zi, yi, xi]
+                f1 = fdata[ti, zi+1, yi, xi]
             return (1-zeta) * f0 + zeta * f1
         elif self.interp_method == 'linear_invdist_land_tracer':
-            land = np.isclose(self.data[ti, zi:zi+2, yi:yi+2, xi:xi+2], 0.)
+            land = np.isclose(fdata[ti, zi:zi+2, yi:yi+2, xi:xi+2], 0.)
             nb_land = np.sum(land)
             if nb_land == 8:
                 return 0
@@ -952,18 +1005,18 @@ class Field(object):
                                 if land[k][j][i] == 1:  # index search led us directly onto land
                                     return 0
                                 else:
-                                    return self.data[ti, zi+i, yi+j, xi+k]
+                                    return fdata[ti, zi+i, yi+j, xi+k]
                             elif land[k][j][i] == 0:
-                                val += self.data[ti, zi+k, yi+j, xi+i] / distance
+                                val += fdata[ti, zi+k, yi+j, xi+i] / distance
                                 w_sum += 1 / distance
                 return val / w_sum
             else:
-                data = self.data[ti, zi, :, :]
+                data = fdata[ti, zi, :, :]
                 f0 = (1 - xsi) * (1 - eta) * data[yi, xi] + \
                     xsi * (1 - eta) * data[yi, xi + 1] + \
                     xsi * eta * data[yi + 1, xi + 1] + \
                     (1 - xsi) * eta * data[yi + 1, xi]
-                data = self.data[ti, zi + 1, :, :]
+                data = fdata[ti, zi + 1, :, :]
                 f1 = (1 - xsi) * (1 - eta) * data[yi, xi] + \
                     xsi * (1 - eta) * data[yi, xi + 1] + \
                     xsi * eta * data[yi + 1, xi + 1] + \
@@ -978,7 +1031,7 @@ class Field(object):
             elif self.interp_method == 'bgrid_w_velocity':
                 eta = 1.
                 xsi = 1.
-            data = self.data[ti, zi, :, :]
+            data = fdata[ti, zi, :, :]
             f0 = (1-xsi)*(1-eta) * data[yi, xi] + \
                 xsi*(1-eta) * data[yi, xi+1] + \
                 xsi*eta * data[yi+1, xi+1] + \
@@ -986,7 +1039,7 @@ class Field(object):
             if self.gridindexingtype == 'pop' and zi >= self.grid.zdim-2:
                 # Since POP is indexed at cell top, allow linear interpolation of W to zero in lowest cell
                 return (1-zeta) * f0
-            data = self.data[ti, zi+1, :, :]
+            data = fdata[ti, zi+1, :, :]
             f1 = (1-xsi)*(1-eta) * data[yi, xi] + \
                 xsi*(1-eta) * data[yi, xi+1] + \
                 xsi*eta * data[yi+1, xi+1] + \
@@ -997,7 +1050,7 @@ class Field(object):
             else:
                 return (1-zeta) * f0 + zeta * f1
         elif self.interp_method in ['cgrid_tracer', 'bgrid_tracer']:
-            return self.data[ti, zi, yi+1, xi+1]
+            return fdata[ti, zi, yi+1, xi+1]
         else:
             raise RuntimeError(self.interp_method+" is not implemented for 3D grids")
 
@@ -1099,18 +1152,74 @@ class Field(object):
         else:
             return value
 
+    def sample_column(self, time, particle, name):
+        """Samples the Field in the vertical column at the position of a particle, into the ColumnVariable `name`
+        of the particle: at the depths of the ColumnVariable, or at the depth levels of the Field if it has no depths.
+        In JIT mode, the time and horizontal index searches are done only once for the whole profile
+
+        :param time: Time at which the Field is sampled
+        :param particle: Particle of a SoA ParticleSet
+        :param name: Name of the ColumnVariable of the particle
+        """
+        var = next((v for v in particle.getPType().variables if v.name == name), None)
+        column = getattr(particle, name)
+        if not hasattr(var, 'depths') or not isinstance(column, np.ndarray):
+            raise NotImplementedError("Field.sample_column() needs a ColumnVariable, of a particle in a SoA ParticleSet")
+        if var.depths is not None:
+            depths = var.depths
+        elif var.size != self.grid.zdim:
+            raise ValueError("ColumnVariable %s has size %d, but Field %s has %d depth levels"
+                             % (name, var.size, self.name, self.grid.zdim))
+        else:
+            depths = self.column_levels(time, particle.lat, particle.lon)
+        column[:] = [self.eval(time, z, particle.lat, particle.lon, particle=particle) for z in depths]
+
+    def column_levels(self, time, y, x):
+        """Depths of the levels of the Field in the vertical column at (x, y), which vary horizontally on an S-grid"""
+        if self.grid.gtype in [GridCode.RectilinearZGrid, GridCode.CurvilinearZGrid]:
+            return self.grid.depth
+        ti, _ = self.time_index(time)
+        (xsi, eta, _, xi, yi, _) = self.search_indices(x, y, 0, ti, time, search2D=True)
+        if self.interp_method in ['bgrid_velocity', 'bgrid_w_velocity', 'bgrid_tracer']:
+            xsi = eta = 1  # as in the vertical search of an S-grid
+        depth = self.grid.depth[ti] if len(self.grid.depth.shape) == 4 else self.grid.depth
+        return ((1-xsi)*(1-eta) * depth[:, yi, xi] + xsi*(1-eta) * depth[:, yi, xi+1]
+                + xsi*eta * depth[:, yi+1, xi+1] + (1-xsi)*eta * depth[:, yi+1, xi])
+
+    @property
+    def static(self):
+        """Whether the Field has no time axis (e.g. bathymetry, a land mask or a constant diffusivity), so that
+        the generated kernel code samples it with static_interpolation(), without a time index search"""
+        return self.grid.tdim == 1 and bool(self.allow_time_extrapolation) and not isinstance(self.data, DeferredArray)
+
+    @property
+    def dense(self):
+        """Whether the data of a static Field is not chunked (i.e. it is a numpy array, as for chunksize=False),
+        so that it is a single block that is always loaded and is read without checking its load state"""
+        return self.static and isinstance(self.data, np.ndarray)
+
     def ccode_eval_array(self, var, t, z, y, x):
         # Casting interp_methd to int as easier to pass on in C-code
+        if self.static:
+            return "static_interpolation(%s, %s, %s, %s, &particles->xi[pnum*ngrid], &particles->yi[pnum*ngrid], &particles->zi[pnum*ngrid], &%s, %s, %s, %d)" \
+                   % (x, y, z, self.ccode_name, var, self.interp_method.upper(), self.gridindexingtype.upper(), self.dense)
         ccode_str = "temporal_interpolation(%s, %s, %s, %s, %s, &particles->xi[pnum*ngrid], &particles->yi[pnum*ngrid], &particles->zi[pnum*ngrid], &particles->ti[pnum*ngrid], &%s, %s, %s)" \
                     % (x, y, z, t, self.ccode_name, var, self.interp_method.upper(), self.gridindexingtype.upper())
         return ccode_str
 
     def ccode_eval_object(self, var, t, z, y, x):
         # Casting interp_methd to int as easier to pass on in C-code
+        if self.static:
+            return "static_interpolation_pstruct(%s, %s, %s, %s, particle->cxi, particle->cyi, particle->czi, &%s, %s, %s, %d)" \
+                   % (x, y, z, self.ccode_name, var, self.interp_method.upper(), self.gridindexingtype.upper(), self.dense)
         ccode_str = "temporal_interpolation_pstruct(%s, %s, %s, %s, %s, particle->cxi, particle->cyi, particle->czi, particle->cti, &%s, %s, %s)" \
                     % (x, y, z, t, self.ccode_name, var, self.interp_method.upper(), self.gridindexingtype.upper())
         return ccode_str
 
+    def ccode_sample_column_array(self, values, nz, depths, t):
+        return "column_interpolation(particles->lon[pnum], particles->lat[pnum], %s, %s, &particles->xi[pnum*ngrid], &particles->yi[pnum*ngrid], &particles->zi[pnum*ngrid], &particles->ti[pnum*ngrid], %s, %d, %s, %s, %s)" \
+               % (t, self.ccode_name, values, nz, depths, self.interp_method.upper(), self.gridindexingtype.upper())
+
     def ccode_convert(self, _, z, y, x):
         return self.units.ccode_to_target(x, y, z)
 
@@ -1151,17 +1260,25 @@ class Field(object):
             self.chunk_setup()
         g = self.grid
         if isinstance(self.data, da.core.Array):
+            requested = []
+            released = []
             for block_id in range(len(self.grid.load_chunk)):
                 if g.load_chunk[block_id] == g.chunk_loading_requested \
                         or g.load_chunk[block_id] in g.chunk_loaded and self.data_chunks[block_id] is None:
-                    block = self.get_block(block_id)
-                    self.data_chunks[block_id] = np.array(self.data.blocks[(slice(self.grid.tdim),) + block])
+                    requested.append(block_id)
                 elif g.load_chunk[block_id] == g.chunk_not_loaded:
+                    if self.chunk_compressor is not None and self.data_chunks[block_id] is not None:
+                        released.append(block_id)
+                        continue
                     if isinstance(self.data_chunks, list):
                         self.data_chunks[block_id] = None
                     else:
                         self.data_chunks[block_id, :] = None
                     self.c_data_chunks[block_id] = None
+            if released:
+                self.compress_chunks(released)
+            for block_id, block in zip(requested, self.read_blocks(requested)):
+                self.data_chunks[block_id] = block
         else:
             if isinstance(self.data_chunks, list):
                 self.data_chunks[0] = None
@@ -1169,7 +1286,79 @@ class Field(object):
                 self.data_chunks[0, :] = None
             self.c_data_chunks[0] = None
             self.grid.load_chunk[0] = g.chunk_loaded_touched
-            self.data_chunks[0] = np.array(self.data)
+            self.data_chunks[0] = array_placed(self.data, copy=not isinstance(self.filebuffers[0], SharedMemoryFileBuffer))
+
+    def read_blocks(self, block_ids):
+        """Arrays of the blocks block_ids of the dask data, for data_chunks. Blocks with a compressed copy are
+        decompressed; the others are computed together, so that dask reads and ingests them in parallel.
+        The computed blocks are usually new arrays, so they are only copied if they are not contiguous or placed.
+        A block of a dask array that wraps a numpy array without any further operation can be a view of that array,
+        in which case the chunk aliases it"""
+        blocks = {}
+        cached = [block_id for block_id in block_ids if block_id in self.compressed_chunks]
+        if cached:
+            tic = tracer.now()
+            for block_id in cached:
+                blocks[block_id] = self.chunk_compressor.decompress(self.compressed_chunks.pop(block_id))
+            tracer.add_span('decompress chunks', 'field', tic, field=self.name, blocks=len(cached))
+        read = [block_id for block_id in block_ids if block_id not in blocks]
+        computed = da.compute(*[self.data.blocks[(slice(self.grid.tdim),) + self.get_block(block_id)] for block_id in read])
+        for block_id, block in zip(read, computed):
+            blocks[block_id] = array_placed(block, copy=False)
+        return [blocks[block_id] for block_id in block_ids]
+
+    def compress_chunks(self, block_ids):
+        """Replaces the loaded blocks block_ids in data_chunks by compressed copies, which are decompressed
+        instead of read again when the blocks are requested, until the time slices of the Field are updated"""
+        tic = tracer.now()
+        nbytes = 0
+        for block_id in block_ids:
+            if self.data_chunks[block_id] is None:
+                continue
+            nbytes += self.data_chunks[block_id].nbytes
+            self.compressed_chunks[block_id] = self.chunk_compressor.compress(self.data_chunks[block_id])
+            self.data_chunks[block_id] = None
+            self.c_data_chunks[block_id] = None
+        tracer.add_span('compress chunks', 'field', tic, field=self.name, blocks=len(block_ids), bytes=nbytes)
+
+    def discard_compressed_chunks(self):
+        """Drops the compressed blocks, and the loaded blocks that are no longer requested, when
+        the time slices of the Field are updated (so that they are not compressed with outdated data)"""
+        if self.chunk_compressor is None:
+            return
+        self.compressed_chunks = {}
+        for block_id in np.flatnonzero(self.grid.load_chunk == self.grid.chunk_not_loaded):
+            self.data_chunks[block_id] = None
+            self.c_data_chunks[block_id] = None
+
+    @property
+    def interpolation_data(self):
+        """The data as read by the Scipy interpolators: Field.data itself, or for dask data a ChunkedFieldData
+        view that only loads the blocks that are interpolated in"""
+        if not isinstance(self.data, da.core.Array):
+            return self.data
+        if self._chunked_view is None or self._chunked_view.data is not self.data:
+            if not self.chunk_set:
+                self.chunk_setup()
+            self._chunked_view = ChunkedFieldData(self)
+        return self._chunked_view
+
+    def memory_usage(self):
+        """Bytes resident for this field: 'data_bytes' of a loaded numpy data array, 'chunk_bytes' of the
+        data_chunks passed to the JIT code that are not views of it, 'compressed_bytes' of the compressed
+        cold blocks, their sum 'bytes', and the part of it that is in the periodic halo ('halo_bytes').
+        Lazy (dask) data that is not in a chunk is not resident. 'time_slices' is the number of time steps held"""
+        data_bytes = self.data.nbytes if isinstance(self.data, np.ndarray) else 0
+        chunk_bytes = 0
+        for chunk in self.data_chunks:
+            if isinstance(chunk, np.ndarray) and not (data_bytes and np.may_share_memory(chunk, self.data)):
+                chunk_bytes += chunk.nbytes
+        compressed_bytes = sum(c.nbytes for c in self.compressed_chunks.values())
+        nbytes = data_bytes + chunk_bytes + compressed_bytes
+        g = self.grid
+        halo_fraction = 1. - (g.xdim - 2*g.zonal_halo) * (g.ydim - 2*g.meridional_halo) / float(g.xdim * g.ydim)
+        return {'bytes': nbytes, 'data_bytes': data_bytes, 'chunk_bytes': chunk_bytes,
+                'compressed_bytes': compressed_bytes, 'halo_bytes': int(nbytes * halo_fraction), 'time_slices': g.tdim}
 
     @property
     def ctypes_struct(self):
@@ -1193,7 +1382,7 @@ class Field(object):
                 raise ValueError('data_chunks should have been loaded by now if requested. grid.load_chunk[bid] cannot be 1')
             if self.grid.load_chunk[i] in self.grid.chunk_loaded:
                 if not self.data_chunks[i].flags.c_contiguous:
-                    self.data_chunks[i] = self.data_chunks[i].copy()
+                    self.data_chunks[i] = array_placed(self.data_chunks[i])
                 self.c_data_chunks[i] = self.data_chunks[i].ctypes.data_as(POINTER(POINTER(c_float)))
             else:
                 self.c_data_chunks[i] = None
@@ -1308,14 +1497,7 @@ class Field(object):
         dset.to_netcdf(filepath)
 
     def rescale_and_set_minmax(self, data):
-        data[np.isnan(data)] = 0
-        if self._scaling_factor:
-            data *= self._scaling_factor
-        if self.vmin is not None:
-            data[data < self.vmin] = 0
-        if self.vmax is not None:
-            data[data > self.vmax] = 0
-        return data
+        return ingest(data, self._scaling_factor, self.vmin, self.vmax, self.keepbits, inplace=True)
 
     def data_concatenate(self, data, data_to_concat, tindex):
         if data[tindex] is not None:
@@ -1345,6 +1527,7 @@ class Field(object):
             self.time = self.grid.time
 
     def computeTimeChunk(self, data, tindex):
+        tic = tracer.now()
         g = self.grid
         timestamp = self.timestamps
         if timestamp is not None:
@@ -1379,8 +1562,31 @@ class Field(object):
             buffer_data = lib.reshape(buffer_data, sum(((buffer_data.shape[0], 1, ), buffer_data.shape[1:]), ()))
         data = self.data_concatenate(data, buffer_data, tindex)
         self.filebuffers[tindex] = filebuffer
+        tracer.add_span('load chunk', 'io', tic, field=self.name, file=self.dataFiles[g.ti + tindex])
         return data
 
+    def computeSharedTimeWindow(self, signdt):
+        """Points the data of a Field from a SharedMemoryFileBuffer at the ring slots of its two time slices
+        (without copying), after waiting until the producer has published them. Each slot is post-processed
+        (see Field.rescale_and_set_minmax()) in place once per slice, since the consumer owns it until it is released"""
+        if signdt < 0:
+            raise NotImplementedError('Fields from shared memory can only be executed forward in time')
+        tic = tracer.now()
+        g = self.grid
+        filebuffer = self.filebuffers[0]
+        filebuffer.ti = g.ti
+        data = filebuffer.data
+        slot = g.ti % filebuffer.ring.nslots
+        for i in range(2):
+            if self._ingested_slots.get(slot + i) != g.ti + i:
+                self.rescale_and_set_minmax(data[i])
+                self._ingested_slots[slot + i] = g.ti + i
+        self.data = self.reshape(data)
+        self.loaded_time_indices = [0, 1]
+        if not self.chunk_set:
+            self.chunk_setup()
+        tracer.add_span('map shared slices', 'io', tic, field=self.name, ti=int(g.ti))
+
     def __add__(self, field):
         if isinstance(self, Field) and isinstance(field, Field):
             return SummedField('_SummedField', [self, field])
@@ -1465,26 +1671,26 @@ class VectorField(object):
         c4 = self.dist(px[3], px[0], py[3], py[0], grid.mesh, np.dot(i_u.phi2D_lin(0., eta), py))
         if grid.zdim == 1:
             if self.gridindexingtype == 'nemo':
-                U0 = self.U.data[ti, yi+1, xi] * c4
-                U1 = self.U.data[ti, yi+1, xi+1] * c2
-                V0 = self.V.data[ti, yi, xi+1] * c1
-                V1 = self.V.data[ti, yi+1, xi+1] * c3
+                U0 = self.U.interpolation_data[ti, yi+1, xi] * c4
+                U1 = self.U.interpolation_data[ti, yi+1, xi+1] * c2
+                V0 = self.V.interpolation_data[ti, yi, xi+1] * c1
+                V1 = self.V.interpolation_data[ti, yi+1, xi+1] * c3
             elif self.gridindexingtype == 'mitgcm':
-                U0 = self.U.data[ti, yi, xi] * c4
-                U1 = self.U.data[ti, yi, xi + 1] * c2
-                V0 = self.V.data[ti, yi, xi] * c1
-                V1 = self.V.data[ti, yi + 1, xi] * c3
+                U0 = self.U.interpolation_data[ti, yi, xi] * c4
+                U1 = self.U.interpolation_data[ti, yi, xi + 1] * c2
+                V0 = self.V.interpolation_data[ti, yi, xi] * c1
+                V1 = self.V.interpolation_data[ti, yi + 1, xi] * c3
         else:
             if self.gridindexingtype == 'nemo':
-                U0 = self.U.data[ti, zi, yi+1, xi] * c4
-                U1 = self.U.data[ti, zi, yi+1, xi+1] * c2
-                V0 = self.V.data[ti, zi, yi, xi+1] * c1
-                V1 = self.V.data[ti, zi, yi+1, xi+1] * c3
+                U0 = self.U.interpolation_data[ti, zi, yi+1, xi] * c4
+                U1 = self.U.interpolation_data[ti, zi, yi+1, xi+1] * c2
+                V0 = self.V.interpolation_data[ti, zi, yi, xi+1] * c1
+                V1 = self.V.interpolation_data[ti, zi, yi+1, xi+1] * c3
             elif self.gridindexingtype == 'mitgcm':
-                U0 = self.U.data[ti, zi, yi, xi] * c4
-                U1 = self.U.data[ti, zi, yi, xi + 1] * c2
-                V0 = self.V.data[ti, zi, yi, xi] * c1
-                V1 = self.V.data[ti, zi, yi + 1, xi] * c3
+                U0 = self.U.interpolation_data[ti, zi, yi, xi] * c4
+                U1 = self.U.interpolation_data[ti, zi, yi, xi + 1] * c2
+                V0 = self.V.interpolation_data[ti, zi, yi, xi] * c1
+                V1 = self.V.interpolation_data[ti, zi, yi + 1, xi] * c3
         U = (1-xsi) * U0 + xsi * U1
         V = (1-eta) * V0 + eta * V1
         rad = np.pi/180.
@@ -1533,12 +1739,12 @@ class VectorField(object):
             pz = np.array([grid.depth[zi, yi, xi], grid.depth[zi, yi, xi+1], grid.depth[zi, yi+1, xi+1], grid.depth[zi, yi+1, xi],
                            grid.depth[zi+1, yi, xi], grid.depth[zi+1, yi, xi+1], grid.depth[zi+1, yi+1, xi+1], grid.depth[zi+1, yi+1, xi]])
 
-        u0 = self.U.data[ti, zi, yi+1, xi]
-        u1 = self.U.data[ti, zi, yi+1, xi+1]
-        v0 = self.V.data[ti, zi, yi, xi+1]
-        v1 = self.V.data[ti, zi, yi+1, xi+1]
-        w0 = self.W.data[ti, zi, yi+1, xi+1]
-        w1 = self.W.data[ti, zi+1, yi+1, xi+1]
+        u0 = self.U.interpolation_data[ti, zi, yi+1, xi]
+        u1 = self.U.interpolation_data[ti, zi, yi+1, xi+1]
+        v0 = self.V.interpolation_data[ti, zi, yi, xi+1]
+        v1 = self.V.interpolation_data[ti, zi, yi+1, xi+1]
+        w0 = self.W.interpolation_data[ti, zi, yi+1, xi+1]
+        w1 = self.W.interpolation_data[ti, zi+1, yi+1, xi+1]
 
         U0 = u0 * i_u.jacobian3D_lin_face(px, py, pz, 0, eta, zet, 'zonal', grid.mesh)
         U1 = u1 * i_u.jacobian3D_lin_face(px, py, pz, 1, eta, zet, 'zonal', grid.mesh)
@@ -1673,6 +1879,113 @@ class VectorField(object):
                 else:
                     return self.spatial_c_grid_interpolation2D(ti, z, y, x, grid.time[ti], particle=particle)
 
+    def index_space_corners(self, xi, yi):
+        """Coordinates of the corners of cell (xi, yi) of the grid of U, counter-clockwise from (xi, yi),
+        with the longitudes unwrapped relative to the first corner on spherical meshes"""
+        grid = self.U.grid
+        if grid.gtype in [GridCode.RectilinearZGrid, GridCode.RectilinearSGrid]:
+            px = np.array([grid.lon[xi], grid.lon[xi+1], grid.lon[xi+1], grid.lon[xi]], dtype=np.float64)
+            py = np.array([grid.lat[yi], grid.lat[yi], grid.lat[yi+1], grid.lat[yi+1]], dtype=np.float64)
+        else:
+            px = np.array([grid.lon[yi, xi], grid.lon[yi, xi+1], grid.lon[yi+1, xi+1], grid.lon[yi+1, xi]], dtype=np.float64)
+            py = np.array([grid.lat[yi, xi], grid.lat[yi, xi+1], grid.lat[yi+1, xi+1], grid.lat[yi+1, xi]], dtype=np.float64)
+        if grid.mesh == 'spherical':
+            px[1:] = np.where(px[1:] - px[0] > 180, px[1:]-360, px[1:])
+            px[1:] = np.where(-px[1:] + px[0] > 180, px[1:]+360, px[1:])
+        return px, py
+
+    def index_space_position(self, gx, gy, lon=None):
+        """Longitude and latitude of the continuous grid index (gx, gy) on the grid of U (extrapolated from the
+        nearest cell outside of the grid). On spherical meshes the longitude is shifted to within 180 degrees of lon"""
+        grid = self.U.grid
+        xi = min(max(int(math.floor(gx)), 0), grid.xdim-2)
+        yi = min(max(int(math.floor(gy)), 0), grid.ydim-2)
+        px, py = self.index_space_corners(xi, yi)
+        phi = i_u.phi2D_lin(gx - xi, gy - yi)
+        x, y = np.dot(phi, px), np.dot(phi, py)
+        if grid.mesh == 'spherical' and lon is not None:
+            x += 360 * round((lon - x) / 360.)
+        return x, y
+
+    def index_space_velocity(self, time, gx, gy):
+        """Velocity at time in the index space of the grid of U, in cells per second, at the continuous grid
+        index (gx, gy). The velocity is interpolated bilinearly in the cell and converted through the inverse
+        of the Jacobian of the cell (in metres on spherical meshes)"""
+        grid = self.U.grid
+        if not (0 <= gx <= grid.xdim-1 and 0 <= gy <= grid.ydim-1):
+            x, y = self.index_space_position(gx, gy)
+            raise FieldOutOfBoundError(x, y, 0, field=self.U)
+        xi = min(int(math.floor(gx)), grid.xdim-2)
+        yi = min(int(math.floor(gy)), grid.ydim-2)
+        xsi, eta = gx - xi, gy - yi
+        phi = i_u.phi2D_lin(xsi, eta)
+
+        (ti, periods) = self.U.time_index(time)
+        time -= periods*(grid.time_full[-1]-grid.time_full[0])
+        uv = []
+        for f in [self.U, self.V]:
+            data = f.interpolation_data
+            val = np.dot(phi, [float(data[ti, yi, xi]), float(data[ti, yi, xi+1]),
+                               float(data[ti, yi+1, xi+1]), float(data[ti, yi+1, xi])])
+            if ti < grid.tdim-1 and time > grid.time[ti]:
+                val1 = np.dot(phi, [float(data[ti+1, yi, xi]), float(data[ti+1, yi, xi+1]),
+                                    float(data[ti+1, yi+1, xi+1]), float(data[ti+1, yi+1, xi])])
+                val += (val1 - val) * ((time - grid.time[ti]) / (grid.time[ti+1] - grid.time[ti]))
+            uv.append(val)
+
+        px, py = self.index_space_corners(xi, yi)
+        if grid.mesh == 'spherical':
+            deg2m = 1852 * 60.
+            jac_lon, jac_lat = deg2m * math.cos(np.pi / 180. * np.dot(phi, py)), deg2m
+        else:
+            jac_lon, jac_lat = 1., 1.
+        dphidxsi = [eta-1, 1-eta, eta, -eta]
+        dphideta = [xsi-1, -xsi, xsi, 1-xsi]
+        dxdxsi = np.dot(px, dphidxsi) * jac_lon
+        dxdeta = np.dot(px, dphideta) * jac_lon
+        dydxsi = np.dot(py, dphidxsi) * jac_lat
+        dydeta = np.dot(py, dphideta) * jac_lat
+        jac = dxdxsi*dydeta - dxdeta*dydxsi
+        if jac == 0:
+            raise FieldSamplingError(*self.index_space_position(gx, gy), 0, field=self.U)
+        return ((dydeta*uv[0] - dxdeta*uv[1]) / jac, (dxdxsi*uv[1] - dydxsi*uv[0]) / jac)
+
+    def advect_index_space(self, time, particle):
+        """Advances a particle over particle.dt with fourth-order Runge-Kutta integration in the index space of
+        the grid of U (see :func:`parcels.application_kernels.advection.AdvectionRK4_IndexSpace`).
+
+        The particle keeps its cell in particle.xi and particle.yi and its position in the cell in
+        particle.xsi and particle.eta, so no index search is needed while it is advected in index space. Its
+        lon and lat are materialised from these after the step. The index search is only done when the
+        index-space position does not materialise to the particle's lon and lat anymore (at the first step,
+        or after another kernel moved the particle)"""
+        grid = self.U.grid
+        igrid = self.U.igrid
+        xi, yi = particle.xi[igrid], particle.yi[igrid]
+        valid = 0 <= xi < grid.xdim-1 and 0 <= yi < grid.ydim-1 and 0 <= particle.xsi <= 1 and 0 <= particle.eta <= 1
+        if valid:
+            x, y = self.index_space_position(xi + particle.xsi, yi + particle.eta, particle.lon)
+            valid = np.float32(x) == np.float32(particle.lon) and np.float32(y) == np.float32(particle.lat)
+        if not valid:
+            (particle.xsi, particle.eta, _, xi, yi, _) = self.U.search_indices(particle.lon, particle.lat, particle.depth,
+                                                                               particle=particle, search2D=True)
+        gx, gy = xi + particle.xsi, yi + particle.eta
+
+        dt = particle.dt
+        (u1, v1) = self.index_space_velocity(time, gx, gy)
+        (u2, v2) = self.index_space_velocity(time + .5 * dt, gx + u1*.5*dt, gy + v1*.5*dt)
+        (u3, v3) = self.index_space_velocity(time + .5 * dt, gx + u2*.5*dt, gy + v2*.5*dt)
+        (u4, v4) = self.index_space_velocity(time + dt, gx + u3*dt, gy + v3*dt)
+        gx += (u1 + 2*u2 + 2*u3 + u4) / 6. * dt
+        gy += (v1 + 2*v2 + 2*v3 + v4) / 6. * dt
+
+        # a position outside of the grid is kept (extrapolated) so that the next step raises the out-of-bounds error
+        xi = min(max(int(math.floor(gx)), 0), grid.xdim-2)
+        yi = min(max(int(math.floor(gy)), 0), grid.ydim-2)
+        particle.xi[igrid], particle.yi[igrid] = xi, yi
+        particle.xsi, particle.eta = gx - xi, gy - yi
+        particle.lon, particle.lat = self.index_space_position(gx, gy, particle.lon)
+
     def __getitem__(self, key):
         if _isParticle(key):
             return self.eval(key.time, key.depth, key.lat, key.lon, key)
@@ -1711,6 +2024,15 @@ class VectorField(object):
                         % (varU, varV, U.interp_method.upper(), U.gridindexingtype.upper())
         return ccode_str
 
+    def ccode_advect_index_space_array(self, varX, varY, t):
+        return "advection_rk4_index_space(%s, %s, %s, particles->dt[pnum], " % (self.U.ccode_name, self.V.ccode_name, t) + \
+               "&particles->xi[pnum*ngrid], &particles->yi[pnum*ngrid], &particles->ti[pnum*ngrid], " \
+               "&particles->xsi[pnum], &particles->eta[pnum], &%s, &%s)" % (varX, varY)
+
+    def ccode_advect_index_space_object(self, varX, varY, t):
+        return "advection_rk4_index_space_pstruct(%s, %s, %s, particle->dt, " % (self.U.ccode_name, self.V.ccode_name, t) + \
+               "particle->cxi, particle->cyi, particle->cti, &particle->xsi, &particle->eta, &%s, &%s)" % (varX, varY)
+
 
 class DeferredArray():
     """Class used for throwing error when Field.data is not read in deferred loading mode"""
@@ -1735,6 +2057,60 @@ class DeferredArray():
         raise RuntimeError("Field is in deferred_load mode, so can't be accessed. Use .computeTimeChunk() method to force loading of data")
 
 
+class ChunkedFieldData(object):
+    """Read-only view of the dask data of a Field for the Scipy interpolators, which reads through the same
+    chunks as JIT mode: indexing loads only the blocks that contain the indexed nodes into Field.data_chunks
+    and marks them as touched in grid.load_chunk, so that they are kept, updated and released as in JIT mode.
+
+    Indices are integers in [-n, n) or ranges (slices without step); leading integers followed by only full slices
+    (as in data[ti, zi, :, :]) return a view of the remaining dimensions. Other integers raise an IndexError
+    """
+    def __init__(self, field, prefix=()):
+        self.field = field
+        self.data = field.data
+        self.prefix = prefix
+        self.shape = self.data.shape[len(prefix):]
+        self.bounds = [np.cumsum((0,) + c) for c in self.data.chunks]
+
+    @staticmethod
+    def _index(i, n):
+        i = int(i)
+        if i < -n or i >= n:
+            raise IndexError('index %d is out of bounds for axis with size %d' % (i, n))
+        return i % n
+
+    def _block(self, block):
+        f = self.field
+        g = f.grid
+        block_id = int(np.ravel_multi_index(block, f.nchunks[1:]))
+        if f.data_chunks[block_id] is None or g.load_chunk[block_id] in [g.chunk_not_loaded, g.chunk_loading_requested]:
+            f.data_chunks[block_id] = f.read_blocks([block_id])[0]
+        g.load_chunk[block_id] = g.chunk_loaded_touched
+        return f.data_chunks[block_id]
+
+    def __getitem__(self, key):
+        key = key if isinstance(key, tuple) else (key,)
+        if len(key) > len(self.shape):
+            raise IndexError('too many indices: %d-dimensional data indexed with %d' % (len(self.shape), len(key)))
+        key = key + (slice(None),) * (len(self.shape) - len(key))
+        nfixed = len(key)
+        while nfixed > 0 and key[nfixed-1] == slice(None):
+            nfixed -= 1
+        if nfixed < len(key) and all(not isinstance(k, slice) for k in key[:nfixed]):
+            return ChunkedFieldData(self.field, self.prefix + tuple(self._index(k, n) for k, n in zip(key[:nfixed], self.shape)))
+        index = [np.arange(*k.indices(n)) if isinstance(k, slice) else np.array([self._index(k, n)])
+                 for k, n in zip(self.prefix + key, self.data.shape)]
+        shape = tuple(len(i) for i, k in zip(index[len(self.prefix):], key) if isinstance(k, slice))
+        # each block that holds indexed nodes is loaded once and sliced for all its nodes
+        blocks = [np.searchsorted(b, i, side='right') - 1 for b, i in zip(self.bounds[1:], index[1:])]
+        out = np.empty(tuple(len(i) for i in index), dtype=self.data.dtype)
+        for block in itertools.product(*[np.unique(b) for b in blocks]):
+            sel = [np.flatnonzero(b == k) for b, k in zip(blocks, block)]
+            local = [i[s] - b[k] for i, s, b, k in zip(index[1:], sel, self.bounds[1:], block)]
+            out[np.ix_(np.arange(len(index[0])), *sel)] = np.asarray(self._block(block))[np.ix_(index[0], *local)]
+        return out.reshape(shape) if shape else out.reshape(())[()]
+
+
 class SummedField(list):
     """Class SummedField is a list of Fields over which Field interpolation
     is summed. This can e.g. be used when combining multiple flow fields,
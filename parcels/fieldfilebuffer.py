@@ -12,6 +12,7 @@ import psutil
 from parcels.tools.converters import convert_xarray_time_units
 from parcels.tools.loggers import logger
 from parcels.tools.statuscodes import DaskChunkingError
+from parcels.tools.sharedmemory import SharedMemoryRing
 
 
 class _FileBuffer(object):
@@ -137,21 +138,26 @@ class NetcdfFileBuffer(_FileBuffer):
                 and data.shape[di] == self.data_full_zdim-1
                 and self.interp_method in ['bgrid_velocity', 'bgrid_w_velocity', 'bgrid_tracer'])
 
+    @staticmethod
+    def _indexer(inds):
+        return inds
+
     def _apply_indices(self, data, ti):
+        ind = self._indexer
         if len(data.shape) == 2:
-            data = data[self.indices['lat'], self.indices['lon']]
+            data = data[ind(self.indices['lat']), ind(self.indices['lon'])]
         elif len(data.shape) == 3:
             if self._check_extend_depth(data, 0):
-                data = data[self.indices['depth'][:-1], self.indices['lat'], self.indices['lon']]
+                data = data[ind(self.indices['depth'][:-1]), ind(self.indices['lat']), ind(self.indices['lon'])]
             elif len(self.indices['depth']) > 1:
-                data = data[self.indices['depth'], self.indices['lat'], self.indices['lon']]
+                data = data[ind(self.indices['depth']), ind(self.indices['lat']), ind(self.indices['lon'])]
             else:
-                data = data[ti, self.indices['lat'], self.indices['lon']]
+                data = data[ti, ind(self.indices['lat']), ind(self.indices['lon'])]
         else:
             if self._check_extend_depth(data, 1):
-                data = data[ti, self.indices['depth'][:-1], self.indices['lat'], self.indices['lon']]
+                data = data[ti, ind(self.indices['depth'][:-1]), ind(self.indices['lat']), ind(self.indices['lon'])]
             else:
-                data = data[ti, self.indices['depth'], self.indices['lat'], self.indices['lon']]
+                data = data[ti, ind(self.indices['depth']), ind(self.indices['lat']), ind(self.indices['lon'])]
         return data
 
     @property
@@ -716,3 +722,114 @@ class DaskFileBuffer(NetcdfFileBuffer):
 class DeferredDaskFileBuffer(DaskFileBuffer):
     def __init__(self, *args, **kwargs):
         super(DeferredDaskFileBuffer, self).__init__(*args, **kwargs)
+
+
+class ZarrFileBuffer(DaskFileBuffer):
+    """ Class that gives deferred access to the data of a Zarr store in the store's own chunking (chunksize='native').
+    The dask array of a variable adopts the chunk grid of the store, with one time step per block, so that the blocks
+    of Field.grid.chunk_info are the chunks of the store: loading a block decompresses a single chunk, and the data
+    is never rechunked. Zarr stores can be read concurrently, so the store is not locked and the blocks that a kernel
+    requests are read in parallel (see Field.chunk_data()).
+    Stores that are chunked along time decompress a whole time chunk for each time step that is loaded.
+    """
+    def __init__(self, *args, **kwargs):
+        kwargs['netcdf_engine'] = 'zarr'
+        kwargs['lock_file'] = False
+        super(ZarrFileBuffer, self).__init__(*args, **kwargs)
+        self.chunksize = 'native'
+
+    def __enter__(self):
+        # chunks={} opens every variable as a dask array with the chunks of the store
+        try:
+            self.dataset = xr.open_dataset(str(self.filename), decode_cf=True, engine='zarr', chunks={})
+            self.dataset['decoded'] = True
+        except:
+            logger.warning_once("Zarr store %s could not be decoded properly by xarray (version %s).\n         It will be opened with no decoding. Filling values might be wrongly parsed."
+                                % (self.filename, xr.__version__))
+            self.dataset = xr.open_dataset(str(self.filename), decode_cf=False, engine='zarr', chunks={})
+            self.dataset['decoded'] = False
+        for inds in self.indices.values():
+            if type(inds) not in [list, range]:
+                raise RuntimeError('Indices for field subsetting need to be a list')
+        return self
+
+    @staticmethod
+    def _indexer(inds):
+        """Contiguous indices as a slice, which keeps the blocks aligned with the chunks of the store
+        (indexing with a list would cut them at other offsets)"""
+        if len(inds) > 0 and inds[-1] - inds[0] == len(inds) - 1 and np.all(np.diff(inds) == 1):
+            return slice(inds[0], inds[-1] + 1)
+        return inds
+
+    def data_access(self):
+        data = self.dataset[self.name]
+        if 'time' in self.dimensions and self.dimensions['time'] in data.dims:
+            time_chunks = data.chunks[data.dims.index(self.dimensions['time'])]
+            if max(time_chunks) > 1:
+                logger.warning_once("Variable %s of Zarr store %s has chunks of %d time steps, which are all "
+                                    "decompressed for each time step that Parcels loads" % (self.name, self.filename, max(time_chunks)))
+
+        ti = range(data.shape[0]) if self.ti is None else self.ti
+        data = self._apply_indices(data, ti).data
+        if not self.chunking_finalized:
+            self.chunk_mapping = dict(enumerate(data.chunksize))
+            if self.rechunk_callback_fields is not None:
+                self.rechunk_callback_fields()
+            self.chunking_finalized = True
+        return data
+
+
+class DeferredZarrFileBuffer(ZarrFileBuffer):
+    def __init__(self, *args, **kwargs):
+        super(DeferredZarrFileBuffer, self).__init__(*args, **kwargs)
+
+
+class SharedMemoryFileBuffer(_FileBuffer):
+    """Buffer of the time slices of a Field that a running model publishes in a SharedMemoryRing,
+    where filename is the name of the ring. data is a view of the ring slots of the two time slices
+    from self.ti (see SharedMemoryRing.window()), so it is not copied, and reading it blocks until they are published.
+    """
+    def __init__(self, *args, **kwargs):
+        self.lib = np
+        self.timeout = kwargs.pop('timeout', None)
+        self.ring = None
+        for k in ['netcdf_engine', 'chunksize', 'rechunk_callback_fields', 'chunkdims_name_map']:
+            kwargs.pop(k, None)
+        super(SharedMemoryFileBuffer, self).__init__(*args, **kwargs)
+
+    def __enter__(self):
+        self.ring = SharedMemoryRing(str(self.filename))
+        return self
+
+    def __exit__(self, type, value, traceback):
+        self.close()
+
+    def close(self):
+        if self.ring is not None:
+            self.ring.close()
+            self.ring = None
+
+    def parse_name(self, name):
+        if name not in self.ring.variables:
+            raise IOError('Variable %s not found in SharedMemoryRing %s' % (name, self.filename))
+        return name
+
+    @property
+    def lonlat(self):
+        return np.array(self.ring.layout['lon']), np.array(self.ring.layout['lat'])
+
+    @property
+    def depth(self):
+        return np.array(self.ring.layout['depth'])
+
+    @property
+    def mesh(self):
+        return self.ring.layout['mesh']
+
+    @property
+    def time(self):
+        return self.ring.time
+
+    @property
+    def data(self):
+        return self.ring.window(self.name, self.ti, timeout=self.timeout)
@@ -9,12 +9,17 @@ from parcels.field import Field, DeferredArray
 from parcels.field import NestedField
 from parcels.field import SummedField
 from parcels.field import VectorField
+from parcels.fieldfilebuffer import SharedMemoryFileBuffer
 from parcels.grid import Grid
 from parcels.gridset import GridSet
 from parcels.grid import GridCode
+from parcels.tools.chunkcompression import ChunkCompressor
 from parcels.tools.converters import TimeConverter, convert_xarray_time_units
+from parcels.tools.landproximity import distance_to_land
+from parcels.tools.statuscodes import BoundaryPolicy
 from parcels.tools.statuscodes import TimeExtrapolationError
 from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
 try:
     from mpi4py import MPI
 except:
@@ -46,6 +51,8 @@ class FieldSet(object):
                 self.add_field(field, name)
 
         self.compute_on_defer = None
+        self.boundary_policy = np.zeros(2, dtype=np.int32)
+        self.boundary_box = np.array([-np.inf, np.inf] * 3, dtype=np.float64)
 
     @staticmethod
     def checkvaliddimensionsdict(dims):
@@ -333,9 +340,12 @@ class FieldSet(object):
                See also the Grid indexing documentation on oceanparcels.org
         :param chunksize: size of the chunks in dask loading. Default is None (no chunking). Can be None or False (no chunking),
                'auto' (chunking is done in the background, but results in one grid per field individually), or a dict in the format
-               '{parcels_varname: {netcdf_dimname : (parcels_dimname, chunksize_as_int)}, ...}', where 'parcels_dimname' is one of ('time', 'depth', 'lat', 'lon')
+               '{parcels_varname: {netcdf_dimname : (parcels_dimname, chunksize_as_int)}, ...}', where 'parcels_dimname' is one of ('time', 'depth', 'lat', 'lon').
+               For Zarr stores, 'native' adopts the chunks of the store (one grid per field), so that each block that
+               Parcels loads is one chunk of the store, read without locking and without rechunking
         :param netcdf_engine: engine to use for netcdf reading in xarray. Default is 'netcdf',
-               but in cases where this doesn't work, setting netcdf_engine='scipy' could help
+               but in cases where this doesn't work, setting netcdf_engine='scipy' could help.
+               Use netcdf_engine='zarr' for Zarr stores (the filenames are then the paths of the stores)
 
         For usage examples see the following tutorials:
 
@@ -389,7 +399,7 @@ class FieldSet(object):
                                 possibly_samegrid &= False
                     if not possibly_samegrid:
                         break
-                    if varchunksize == 'auto':
+                    if varchunksize in ['auto', 'native']:
                         break
                     if 'depth' in dims and dims['depth'] == 'not_yet_set':
                         break
@@ -929,6 +939,44 @@ class FieldSet(object):
         v = fields.pop('V', None)
         return cls(u, v, fields=fields)
 
+    @classmethod
+    def from_shared_memory(cls, ringname, variables=None, timeout=None, **kwargs):
+        """Initialises FieldSet data from the time slices that a running model (the producer) publishes in a
+        :class:`parcels.tools.sharedmemory.SharedMemoryRing`, to track particles online, while the model runs.
+        All Fields share the grid of the ring. Their data is not copied: FieldSet.computeTimeChunk() points it
+        at the ring slots of the loaded time slices, and blocks until the producer has published them.
+
+        :param ringname: Name of the shared memory block of the ring
+        :param variables: Dictionary mapping parcels variable names to variable names in the ring.
+               Default is all variables of the ring, with the same names
+        :param timeout: Maximum number of seconds to wait for a time slice (default: no limit)
+        """
+        if 'creation_log' not in kwargs.keys():
+            kwargs['creation_log'] = 'from_shared_memory'
+        fields = {}
+        grid = None
+        if variables is None:
+            with SharedMemoryFileBuffer(ringname, {}, {}) as filebuffer:
+                variables = {v: v for v in filebuffer.ring.variables}
+        try:
+            for var, name in variables.items():
+                fields[var] = Field.from_shared_memory(ringname, (var, name), grid=grid, timeout=timeout, **kwargs)
+                grid = fields[var].grid
+        except Exception:
+            for field in fields.values():
+                field.close()
+            raise
+        u = fields.pop('U', None)
+        v = fields.pop('V', None)
+        return cls(u, v, fields=fields)
+
+    def close(self):
+        """Closes the file buffers that the Fields of this FieldSet hold open (see Field.close()), e.g. to
+        detach from the SharedMemoryRing of a FieldSet from FieldSet.from_shared_memory()"""
+        for f in self.get_fields():
+            if isinstance(f, Field):
+                f.close()
+
     def get_fields(self):
         """Returns a list of all the :class:`parcels.field.Field` and :class:`parcels.field.VectorField`
         objects associated with this FieldSet"""
@@ -945,6 +993,28 @@ class FieldSet(object):
                         fields.append(v2)
         return fields
 
+    def memory_usage(self):
+        """Bytes held by the fields (see Field.memory_usage) and grids (see Grid.memory_usage) of this FieldSet
+
+        :return: Dictionary with 'fields' (by name, with a #i suffix for repeated names), 'grids' (by grid index,
+                 with the names of their fields) and the total 'bytes'
+        """
+        usage = {'fields': {}, 'grids': {}, 'bytes': 0}
+        for igrid, g in enumerate(self.gridset.grids):
+            usage['grids'][igrid] = dict(g.memory_usage(), fields=[])
+            usage['bytes'] += usage['grids'][igrid]['bytes']
+        for f in self.get_fields():
+            if type(f) is not Field:
+                continue
+            name = f.name
+            while name in usage['fields']:
+                name = '%s#%d' % (f.name, int(name.split('#')[-1]) + 1 if '#' in name else 1)
+            usage['fields'][name] = f.memory_usage()
+            usage['bytes'] += usage['fields'][name]['bytes']
+            if f.grid in self.gridset.grids:
+                usage['grids'][self.gridset.grids.index(f.grid)]['fields'].append(name)
+        return usage
+
     def add_constant(self, name, value):
         """Add a constant to the FieldSet. Note that all constants are
         stored as 32-bit floats. While constants can be updated during
@@ -976,6 +1046,151 @@ class FieldSet(object):
             if isinstance(value, Field):
                 value.add_periodic_halo(zonal, meridional, halosize)
 
+    def add_distance_to_land(self, field=None, landmask=None, name='distance_to_land',
+                             direction_names=('ocean_direction_x', 'ocean_direction_y')):
+        """Add Fields with the signed distance to the coast and the direction to the nearest ocean
+        (see :func:`parcels.tools.landproximity.distance_to_land`), so that a beaching kernel can
+        detect land with a single sample, e.g. `fieldset.distance_to_land[time, particle.depth, particle.lat, particle.lon] < 1000`,
+        and move beached particles seaward along (ocean_direction_x, ocean_direction_y).
+        The Fields are defined on the horizontal mesh and depth levels of field, and are constant in time.
+
+        :param field: Field whose zero (or NaN) values at the first time define the land mask. Default is U
+        :param landmask: Optional boolean array of [ydim, xdim] or [zdim, ydim, xdim] on the grid of field,
+               True on land. Required if field is loaded with deferred_load
+        :param name: Name of the distance Field
+        :param direction_names: Names of the eastward and northward direction Fields. None to skip these
+        """
+        field = self.U if field is None else field
+        grid = field.grid
+        if landmask is None:
+            if grid.defer_load:
+                raise ValueError("Field %s is loaded with deferred_load, so a landmask needs to be given to add_distance_to_land()" % field.name)
+            data = np.asarray(field.data)
+            data = data.reshape((-1, grid.zdim, grid.ydim, grid.xdim))[0]
+            landmask = np.logical_or(data == 0, np.isnan(data))
+        landmask = np.asarray(landmask, dtype=bool)
+        if landmask.ndim == 3 and landmask.shape[0] == 1:
+            landmask = landmask[0]
+
+        dist, dirx, diry = distance_to_land(landmask, grid.lon, grid.lat, mesh=grid.mesh)
+        depth = grid.depth if landmask.ndim == 3 else np.zeros(1, dtype=np.float32)
+        names = [name] + ([] if direction_names is None else list(direction_names))
+        for fname, data in zip(names, [dist, dirx, diry]):
+            self.add_field(Field(fname, data, lon=grid.lon, lat=grid.lat, depth=depth, mesh=grid.mesh,
+                                 time_origin=grid.time_origin, interp_method='linear'))
+
+    def set_boundary_policy(self, out_of_bounds=None, through_surface=None, domain=None):
+        """Set the policies for particles that sample a Field out of bounds or through the surface.
+        These are applied directly in the kernel loop, so that particles do not have to go back to the
+        Python recovery kernels. The policy is applied to the particle as it was at the start of the time step
+        that failed, after which that time step is repeated. A particle that ends a successful time step outside
+        the domain is handled in that same step: it is moved into the domain at its end position, or deleted or
+        frozen as if the step had failed.
+        Policies are 'reflect' (mirror the particle back into the domain), 'clamp' (move it to the nearest
+        edge of the domain), 'periodic' (wrap it around the horizontal domain), 'delete', 'freeze'
+        (keep it where it is until the end of the execute() call) or None (use the recovery kernels).
+        The domain is a lon/lat/depth box, so 'reflect', 'clamp' and 'periodic' are only available on rectilinear
+        grids without masked (NaN) coordinates: on other grids, the edges of the box can lie outside the mesh.
+        If a particle is still inside the domain when its time step fails, the error came from a field sample away
+        from the particle, e.g. at an intermediate Runge-Kutta stage. With the first three policies, that time step
+        is then repeated once, with each out-of-bounds sample of a Field or VectorField taken at the position that
+        the policy moves it to (samples of SummedFields and NestedFields are not moved). Particles whose repeated
+        step still fails are left to the recovery kernels.
+
+        :param out_of_bounds: Policy for ErrorOutOfBounds (name or :class:`parcels.tools.statuscodes.BoundaryPolicy` value)
+        :param through_surface: Policy for ErrorThroughSurface. Default is the out_of_bounds policy
+        :param domain: Optional dictionary with (min, max) tuples for 'lon', 'lat' and/or 'depth'.
+               Default is the extent of the U grid, without its periodic halo
+        """
+        def policy_code(policy):
+            if policy is None:
+                return BoundaryPolicy.Recover
+            if isinstance(policy, str):
+                if not hasattr(BoundaryPolicy, policy.capitalize()):
+                    raise ValueError("Unknown boundary policy '%s'" % policy)
+                return getattr(BoundaryPolicy, policy.capitalize())
+            if policy not in range(BoundaryPolicy.Freeze + 1):
+                raise ValueError("Unknown boundary policy %s" % policy)
+            return policy
+
+        policies = [policy_code(out_of_bounds)]
+        policies.append(policies[0] if through_surface is None else policy_code(through_surface))
+        if any(p in [BoundaryPolicy.Reflect, BoundaryPolicy.Clamp, BoundaryPolicy.Periodic] for p in policies):
+            for fld in [getattr(self, v) for v in ['U', 'V', 'W'] if hasattr(self, v)]:
+                for f in ([fld] if isinstance(fld, Field) else fld):
+                    if f.grid.lon.ndim > 1 or np.isnan(f.grid.lon).any() or np.isnan(f.grid.lat).any():
+                        raise NotImplementedError("Boundary policies that move particles (reflect, clamp and periodic) "
+                                                  "are only supported on rectilinear grids without masked coordinates, "
+                                                  "but Field %s is on a curvilinear or masked grid" % f.name)
+        self.boundary_policy[:] = policies
+
+        grid = self.U.grid if isinstance(self.U, Field) else self.U[0].grid
+        xh, yh = grid.zonal_halo, grid.meridional_halo
+        if grid.lon.ndim == 1:
+            lon = grid.lon[xh:grid.lon.size - xh]
+            lat = grid.lat[yh:grid.lat.size - yh]
+        else:
+            lon = grid.lon[yh:grid.ydim - yh, xh:grid.xdim - xh]
+            lat = grid.lat[yh:grid.ydim - yh, xh:grid.xdim - xh]
+        box = {'lon': (np.nanmin(lon), np.nanmax(lon)), 'lat': (np.nanmin(lat), np.nanmax(lat)),
+               'depth': (np.nanmin(grid.depth), np.nanmax(grid.depth))}
+        # dimensions that the index search does not bound (global grids without halo wrap in longitude)
+        if (grid.zonal_periodic and xh == 0) or grid.xdim == 1:
+            box['lon'] = (-np.inf, np.inf)
+        if grid.ydim == 1:
+            box['lat'] = (-np.inf, np.inf)
+        if grid.zdim == 1:
+            box['depth'] = (-np.inf, np.inf)
+        if domain is not None:
+            box.update(domain)
+        for i, dim in enumerate(['lon', 'lat', 'depth']):
+            # rounded inwards to float32, so that a particle moved onto the edge stays inside for float32 coordinates
+            for j, v in enumerate(box[dim]):
+                v32 = np.float32(v)
+                if (v32 < v) if j == 0 else (v32 > v):
+                    v32 = np.nextafter(v32, np.float32(np.inf if j == 0 else -np.inf))
+                self.boundary_box[2*i+j] = v32
+
+    def set_chunk_compression(self, codec='lz4', keepbits=None, clevel=5):
+        """Keep the cold blocks of the chunked (dask) fields compressed in memory, instead of dropping them.
+        A block is cold when no particle has sampled it during a whole kernel execution (e.g. the output interval
+        of ParticleSet.execute()), and when the out-of-core execution of a kernel with a memory_budget releases it.
+        A cold block is compressed and released to the JIT code as not loaded; when a particle samples it again,
+        it is decompressed into Field.data_chunks instead of read from disk. The compressed blocks are dropped when
+        the time slices of their field are updated.
+
+        :param codec: Compressor of the blocks (see :class:`parcels.tools.chunkcompression.ChunkCompressor`):
+               'lz4' (default), 'lz4hc', 'zstd', 'blosclz' or 'zlib', or None to switch compression off
+        :param keepbits: Number of float32 mantissa bits to keep, for lossy compression with a relative error of
+               at most 2**-(keepbits+1) (default None: lossless)
+        :param clevel: Compression level (1 to 9)
+        """
+        compressor = None if codec is None else ChunkCompressor(codec, keepbits=keepbits, clevel=clevel)
+        for f in self.get_fields():
+            if type(f) is not Field:
+                continue
+            f.chunk_compressor = compressor
+            if compressor is None:
+                f.compressed_chunks = {}
+
+    def compress_cold_chunks(self):
+        """Compresses the blocks of the fields with chunk compression (see set_chunk_compression()) that were
+        not touched since the previous call (chunk_deprecated), and marks them as not loaded"""
+        cold = {}
+        for f in self.get_fields():
+            if type(f) is not Field or not isinstance(f.data, da.core.Array) or len(f.grid.load_chunk) == 0:
+                continue
+            g = f.grid
+            if g not in cold:
+                cold[g] = np.flatnonzero(g.load_chunk == g.chunk_deprecated)
+            if f.chunk_compressor is None:
+                cold[g] = []  # the blocks of fields without compression stay loaded, so their grid keeps its state
+        for f in self.get_fields():
+            if type(f) is Field and f.grid in cold and len(cold[f.grid]) > 0:
+                f.compress_chunks(cold[f.grid])
+        for g, blocks in cold.items():
+            g.load_chunk[blocks] = g.chunk_not_loaded
+
     def write(self, filename):
         """Write FieldSet to NetCDF file using NEMO convention
 
@@ -1029,6 +1244,7 @@ class FieldSet(object):
         :param time: Time around which the FieldSet chunks are to be loaded. Time is provided as a double, relatively to Fieldset.time_origin
         :param dt: time step of the integration scheme
         """
+        tic_all = tracer.now()
         signdt = np.sign(dt)
         nextTime = np.infty if dt > 0 else -np.infty
 
@@ -1047,6 +1263,14 @@ class FieldSet(object):
             if type(f) in [VectorField, NestedField, SummedField] or not f.grid.defer_load or f.dataFiles is None:
                 continue
             g = f.grid
+            tic = tracer.now()
+            if isinstance(f.filebuffers[0], SharedMemoryFileBuffer):
+                if g.update_status in ['first_updated', 'updated']:
+                    f.computeSharedTimeWindow(signdt)
+                    g.load_chunk = np.where(g.load_chunk == g.chunk_loaded_touched,
+                                            g.chunk_loading_requested, g.load_chunk)
+                    tracer.add_span('computeTimeChunk', 'field', tic, field=f.name, time=float(time))
+                continue
             if g.update_status == 'first_updated':  # First load of data
                 if f.data is not None and not isinstance(f.data, DeferredArray):
                     if not isinstance(f.data, list):
@@ -1152,6 +1376,9 @@ class FieldSet(object):
                                 block = f.get_block(block_id)
                                 f.data_chunks[block_id][1] = None
                                 f.data_chunks[block_id][0] = np.array(f.data.blocks[(slice(2),)+block][0])
+            if g.update_status in ['first_updated', 'updated']:
+                f.discard_compressed_chunks()
+                tracer.add_span('computeTimeChunk', 'field', tic, field=f.name, time=float(time))
         # do user-defined computations on fieldset data
         if self.compute_on_defer:
             self.compute_on_defer(self)
@@ -1163,6 +1390,7 @@ class FieldSet(object):
             if f.grid.depth_field is not None:
                 depth_data = f.grid.depth_field.data
                 f.grid.depth = depth_data if isinstance(depth_data, np.ndarray) else np.array(depth_data)
+        tracer.add_span('FieldSet.computeTimeChunk', 'field', tic_all, time=float(time))
 
         if abs(nextTime) == np.infty or np.isnan(nextTime):  # Second happens when dt=0
             return nextTime
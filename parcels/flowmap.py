@@ -0,0 +1,204 @@
+"""Precomputed flow maps for repeated releases in steady or time-periodic flow"""
+import numpy as np
+from scipy import sparse
+
+from parcels.application_kernels.advection import AdvectionRK4
+from parcels.field import Field
+from parcels.fieldset import FieldSet
+from parcels.particle import JITParticle
+from parcels.particleset.particlesetsoa import ParticleSetSOA
+from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
+
+__all__ = ['FlowMap']
+
+
+def ApplyFlowMap(particle, fieldset, time):
+    """Kernel that moves a particle by the displacement of the flow map at its position"""
+    (dlon, dlat) = fieldset.UV[time, particle.depth, particle.lat, particle.lon]
+    particle.lon += dlon
+    particle.lat += dlat
+
+
+class FlowMap(object):
+    """Discrete flow map of a FieldSet over a fixed horizon, so that repeated releases in steady or time-periodic
+    (`time_periodic`) flow are propagated by interpolating the map instead of by integrating every particle.
+
+    The map is built by integrating a (dense) lattice of seeds once, from starttime over the horizon, and stores
+    the horizontal displacement of each seed; seeds that are deleted during the integration are lost (NaN).
+    It is valid for releases at starttime plus any multiple of the period of the time-periodic fields of the
+    FieldSet, and for releases at any time if all its fields are steady. The map is 2D: the seeds and the
+    released particles are at a single depth.
+
+    :param fieldset: :mod:`parcels.fieldset.FieldSet` object to integrate
+    :param lon: Monotonically increasing 1D array of the longitudes of the seed lattice
+    :param lat: Monotonically increasing 1D array of the latitudes of the seed lattice
+    :param horizon: Length of the integration (in seconds)
+    :param dt: Timestep of the integration of the seeds (negative for a backward map)
+    :param pyfunc: Kernel function that advects the seeds (default AdvectionRK4)
+    :param pclass: Particle class of the seeds, and of the particles that are propagated with the map
+    :param starttime: Release time of the seeds (default 0)
+    :param depth: Depth of the seeds (default the first depth of the grid of fieldset.U)
+    :param recovery: Dictionary with additional `:mod:parcels.tools.error` recovery kernels for the
+           integration of the seeds, as in ParticleSet.execute()
+    """
+
+    def __init__(self, fieldset, lon, lat, horizon, dt, pyfunc=AdvectionRK4, pclass=JITParticle,
+                 starttime=0., depth=None, recovery=None):
+        self.fieldset = fieldset
+        self.lon = np.asarray(lon, dtype=np.float64)
+        self.lat = np.asarray(lat, dtype=np.float64)
+        self.horizon = horizon
+        self.dt = dt
+        self.pyfunc = pyfunc
+        self.pclass = pclass
+        self.starttime = starttime
+        self.depth = fieldset.U.grid.depth[0] if depth is None else depth
+        self.recovery = recovery
+        self.mesh = fieldset.U.grid.mesh
+        self.period = self._period(fieldset)
+        self._kernel = None
+
+        tic = tracer.now()
+        seedlon, seedlat = np.meshgrid(self.lon, self.lat)
+        end_lon, end_lat = self._integrate(seedlon.ravel(), seedlat.ravel(), starttime)
+        self.end_lon = end_lon.reshape(seedlon.shape)
+        self.end_lat = end_lat.reshape(seedlat.shape)
+        self.lost = np.isnan(self.end_lon) | np.isnan(self.end_lat)
+        dlon = self.end_lon - seedlon
+        if self.mesh == 'spherical':
+            dlon = (dlon + 180) % 360 - 180  # displacement across a periodic boundary
+        # the displacements are the 'velocities' of a flat FieldSet, so that the map is interpolated by UV;
+        # particles next to lost seeds are filtered out before, so that the kernel never signals an error
+        dlat = self.end_lat - seedlat
+        self.mapset = FieldSet(Field('U', np.where(self.lost, 0, dlon).astype(np.float32), lon=self.lon, lat=self.lat,
+                                     mesh='flat'),
+                               Field('V', np.where(self.lost, 0, dlat).astype(np.float32), lon=self.lon, lat=self.lat,
+                                     mesh='flat'))
+        self.mapset.check_complete()
+        tracer.add_span('FlowMap', 'execute', tic, seeds=int(seedlon.size), lost=int(self.lost.sum()))
+
+    @staticmethod
+    def _period(fieldset):
+        """Shift in release time over which the map stays valid: 0 for steady fields (any shift),
+        the period of time-periodic fields, and None if a field is neither"""
+        periods = set()
+        for f in fieldset.get_fields():
+            if not isinstance(f, Field) or f.grid.tdim == 1:
+                continue
+            if f.time_periodic is False:
+                logger.warning_once('Field %s is not time_periodic, so a FlowMap is only valid for releases at '
+                                    'its starttime' % f.name)
+                return None
+            periods.add(float(f.time_periodic))
+        if len(periods) > 1:
+            raise NotImplementedError('FlowMap needs all time-periodic fields to have the same period')
+        return periods.pop() if periods else 0
+
+    def _integrate(self, lon, lat, time):
+        """End positions of particles released at (lon, lat, time) after direct integration over the horizon"""
+        pset = ParticleSetSOA(self.fieldset, pclass=self.pclass, lon=lon, lat=lat, depth=np.full(len(lon), self.depth),
+                              time=time, lonlatdepth_dtype=np.float64, partitions=False)
+        ids = pset.collection.data['id'].copy()
+        pset.execute(self.pyfunc, runtime=self.horizon, dt=self.dt, recovery=self.recovery)
+        end_lon = np.full(len(lon), np.nan)
+        end_lat = np.full(len(lon), np.nan)
+        kept = np.searchsorted(ids, pset.collection.data['id'])
+        end_lon[kept] = pset.collection.data['lon']
+        end_lat[kept] = pset.collection.data['lat']
+        return end_lon, end_lat
+
+    def _is_lost(self, lon, lat):
+        """Whether particles at (lon, lat) are outside the lattice or in a cell with a lost seed"""
+        outside = ~((lon >= self.lon[0]) & (lon <= self.lon[-1]) & (lat >= self.lat[0]) & (lat <= self.lat[-1]))
+        i = np.clip(np.searchsorted(self.lon, lon, side='right') - 1, 0, len(self.lon) - 2)
+        j = np.clip(np.searchsorted(self.lat, lat, side='right') - 1, 0, len(self.lat) - 2)
+        return outside | self.lost[j, i] | self.lost[j, i+1] | self.lost[j+1, i] | self.lost[j+1, i+1]
+
+    def check_time(self, time):
+        """Raises a ValueError if the map is not valid for releases at time"""
+        shift = time - self.starttime
+        if self.period == 0 or (self.period is None and shift == 0):
+            return
+        if self.period is None or not np.isclose(shift / self.period, np.round(shift / self.period)):
+            raise ValueError('FlowMap built for starttime %g is not valid for releases at time %g' % (self.starttime, time))
+
+    def propagate(self, lon, lat, time=None):
+        """Positions after the horizon of particles released at (lon, lat), by (bilinear) interpolation of the map
+        in a JIT kernel. Particles that are released outside the lattice or next to a lost seed are lost (NaN).
+
+        :param lon: Longitudes of the released particles
+        :param lat: Latitudes of the released particles
+        :param time: Release time of the particles (default the starttime of the map)
+        :return: Tuple of the arrays of longitudes and latitudes at time plus the horizon (times the sign of dt)
+        """
+        time = self.starttime if time is None else time
+        self.check_time(time)
+        lon = np.asarray(lon, dtype=np.float64).ravel()
+        lat = np.asarray(lat, dtype=np.float64).ravel()
+        end_lon = np.full(len(lon), np.nan)
+        end_lat = np.full(len(lon), np.nan)
+        kept = np.flatnonzero(~self._is_lost(lon, lat))
+        if len(kept) == 0:
+            return end_lon, end_lat
+        tic = tracer.now()
+        pset = ParticleSetSOA(self.mapset, pclass=self.pclass, lon=lon[kept], lat=lat[kept], time=0,
+                              lonlatdepth_dtype=np.float64, partitions=False)
+        if self._kernel is None:
+            pset._set_kernel(ApplyFlowMap)
+            if pset.collection.ptype.uses_jit:
+                pset._compile_kernel()
+                pset.kernel.load_lib()
+            self._kernel = pset.kernel
+        pset._set_particle_vector('dt', 0.)
+        self._kernel.execute(pset, endtime=0, dt=0, execute_once=True)
+        end_lon[kept] = pset.collection.data['lon']
+        end_lat[kept] = pset.collection.data['lat']
+        tracer.add_span('FlowMap.propagate', 'execute', tic, particles=len(lon))
+        return end_lon, end_lat
+
+    def estimate_error(self, lon, lat, time=None):
+        """Distance between the positions from propagate() and from direct integration of particles released at
+        (lon, lat). The error of the interpolation is largest halfway between seeds, e.g. at the cell centres of
+        the lattice.
+
+        :param lon: Longitudes of the released particles
+        :param lat: Latitudes of the released particles
+        :param time: Release time of the particles (default the starttime of the map)
+        :return: Array of the distances (in m on a spherical mesh), NaN where a particle is lost in either
+        """
+        time = self.starttime if time is None else time
+        map_lon, map_lat = self.propagate(lon, lat, time)
+        int_lon, int_lat = self._integrate(np.asarray(lon, dtype=np.float64).ravel(),
+                                           np.asarray(lat, dtype=np.float64).ravel(), time)
+        if self.mesh == 'flat':
+            return np.hypot(map_lon - int_lon, map_lat - int_lat)
+        lon1, lat1, lon2, lat2 = [np.radians(x) for x in [map_lon, map_lat, int_lon, int_lat]]
+        a = np.sin((lat2 - lat1) / 2)**2 + np.cos(lat1) * np.cos(lat2) * np.sin((lon2 - lon1) / 2)**2
+        return 2 * 6371000. * np.arcsin(np.sqrt(a))
+
+    def transport_matrix(self, lon_edges, lat_edges):
+        """Sparse transport matrix between the boxes of a (lon, lat) binning, from the seeds of the map.
+        Element (i, j) is the fraction of the seeds in box i that end in box j after the horizon, so that
+        a distribution of particles over the boxes (as a row vector) is propagated by multiplying it with the matrix.
+        Seeds that are lost or end outside the boxes make the sum of a row smaller than 1.
+
+        :param lon_edges: Monotonically increasing edges of the longitude bins
+        :param lat_edges: Monotonically increasing edges of the latitude bins
+        :return: scipy.sparse.csr_matrix with one row and column per box, the longitude varying fastest
+        """
+        seedlon, seedlat = np.meshgrid(self.lon, self.lat)
+        nlon, nlat = len(lon_edges) - 1, len(lat_edges) - 1
+
+        def box(lon, lat):
+            i = np.searchsorted(lon_edges, lon, side='right') - 1
+            j = np.searchsorted(lat_edges, lat, side='right') - 1
+            inside = (i >= 0) & (i < nlon) & (j >= 0) & (j < nlat)
+            return np.where(inside, j * nlon + i, -1)
+
+        src = box(seedlon.ravel(), seedlat.ravel())
+        dst = box(self.end_lon.ravel(), self.end_lat.ravel())
+        nseeds = np.bincount(src[src >= 0], minlength=nlon * nlat)
+        valid = (src >= 0) & (dst >= 0)
+        counts = sparse.coo_matrix((np.ones(valid.sum()), (src[valid], dst[valid])), shape=(nlon * nlat, nlon * nlat)).tocsr()
+        return sparse.diags(1. / np.maximum(nseeds, 1)).dot(counts).tocsr()
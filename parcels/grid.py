@@ -29,6 +29,13 @@ class CGrid(Structure):
                 ('grid', c_void_p)]
 
 
+class CHorizontalSearch(Structure):
+    _fields_ = [('valid', c_int),
+                ('x', c_double), ('y', c_double),
+                ('xi', c_int), ('yi', c_int),
+                ('xsi', c_double), ('eta', c_double)]
+
+
 class Grid(object):
     """Grid class that defines a (spatial and temporal) grid on which Fields are defined
 
@@ -70,6 +77,10 @@ class Grid(object):
         self.chunksize = None
         self._add_last_periodic_data_timestep = False
         self.depth_field = None
+        self.use_search_coefs = False
+        self.search_coefs = None
+        self.hgrid = None
+        self.hsearch = None
 
     @staticmethod
     def create_grid(lon, lat, depth, time, time_origin, mesh, **kwargs):
@@ -112,7 +123,9 @@ class Grid(object):
                         ('tfull_min', c_double), ('tfull_max', c_double), ('periods', POINTER(c_int)),
                         ('lonlat_minmax', POINTER(c_float)),
                         ('lon', POINTER(c_float)), ('lat', POINTER(c_float)),
-                        ('depth', POINTER(c_float)), ('time', POINTER(c_double))
+                        ('depth', POINTER(c_float)), ('time', POINTER(c_double)),
+                        ('search_coefs', POINTER(c_double)),
+                        ('hsearch', POINTER(CHorizontalSearch))
                         ]
 
         # Create and populate the c-struct object
@@ -120,6 +133,14 @@ class Grid(object):
             if not isinstance(self.periods, c_int):
                 self.periods = c_int()
                 self.periods.value = 0
+            if self.use_search_coefs and self.search_coefs is None:
+                self.search_coefs = self.compute_search_coefs()
+            hsearch = None
+            if self.hgrid is not None and self.same_horizontal_mesh(self.hgrid):
+                if self.hgrid.hsearch is None:
+                    self.hgrid.hsearch = CHorizontalSearch()
+                hsearch = self.hgrid.hsearch
+                hsearch.valid = 0
             self.cstruct = CStructuredGrid(self.xdim, self.ydim, self.zdim,
                                            self.tdim, self.z4d,
                                            self.mesh == 'spherical', self.zonal_periodic,
@@ -130,9 +151,59 @@ class Grid(object):
                                            self.lon.ctypes.data_as(POINTER(c_float)),
                                            self.lat.ctypes.data_as(POINTER(c_float)),
                                            self.depth.ctypes.data_as(POINTER(c_float)),
-                                           self.time.ctypes.data_as(POINTER(c_double)))
+                                           self.time.ctypes.data_as(POINTER(c_double)),
+                                           None if self.search_coefs is None else self.search_coefs.ctypes.data_as(POINTER(c_double)),
+                                           None if hsearch is None else pointer(hsearch))
         return self.cstruct
 
+    def same_horizontal_mesh(self, grid):
+        """Returns whether the horizontal index search on this grid and on `grid` gives the same (xi, yi, xsi, eta),
+        i.e. whether both grids have the same mesh type, zonal periodicity, search-coefficient setting and lon/lat
+        coordinates (depth and time may differ).
+        Coordinates are compared exactly, since any offset would give a different (xi, yi, xsi, eta)"""
+        if self.mesh != grid.mesh or self.zonal_periodic != grid.zonal_periodic \
+                or self.use_search_coefs != grid.use_search_coefs:
+            return False
+        for attr in ['lon', 'lat']:
+            gattr = getattr(grid, attr)
+            selfattr = getattr(self, attr)
+            if gattr is selfattr:
+                continue
+            if not np.array_equal(gattr, selfattr):
+                return False
+        return True
+
+    def compute_search_coefs(self):
+        """Per-cell coefficient table for the bilinear inverse map of the JIT index search.
+        Only available for curvilinear grids"""
+        raise NotImplementedError('Search coefficients are only available for curvilinear grids')
+
+    def calc_cell_edge_sizes(self):
+        """Computes the zonal ('x') and meridional ('y') cell edge sizes at each grid node,
+        in m for spherical meshes, as centred differences in the interior and one-sided differences
+        at the boundaries (as numpy.gradient). The result is cached in Grid.cell_edge_sizes,
+        which can also be set directly, e.g. from the e1u and e2u fields of a NEMO mesh_mask file"""
+        if not self.cell_edge_sizes:
+            dx, dy = self.compute_cell_edge_sizes()
+            self.cell_edge_sizes['x'] = dx.astype(np.float32)
+            self.cell_edge_sizes['y'] = dy.astype(np.float32)
+        return self.cell_edge_sizes
+
+    def cell_areas(self):
+        """Returns the cell areas, as the product of the cell edge sizes (see calc_cell_edge_sizes)"""
+        self.calc_cell_edge_sizes()
+        return self.cell_edge_sizes['x'] * self.cell_edge_sizes['y']
+
+    @staticmethod
+    def _centred(d, axis):
+        """Node values of the distances d between consecutive nodes along axis, in the same way as numpy.gradient"""
+        d = np.moveaxis(d, axis, -1)
+        if d.shape[-1] == 0:
+            node = np.zeros(d.shape[:-1] + (1,))
+        else:
+            node = np.concatenate((d[..., :1], 0.5 * (d[..., :-1] + d[..., 1:]), d[..., -1:]), axis=-1)
+        return np.moveaxis(node, -1, axis)
+
     def lon_grid_to_target(self):
         if self.lon_remapping:
             self.lon = self.lon_remapping.to_target(self.lon)
@@ -257,6 +328,14 @@ class Grid(object):
     def chunk_loaded(self):
         return [2, 3]
 
+    def memory_usage(self):
+        """Bytes of the numpy arrays of this grid (coordinates and cached geometry and search data) and
+        the number of chunks in each load_chunk state"""
+        states = ['not_loaded', 'loading_requested', 'loaded_touched', 'deprecated']
+        load_chunk = np.asarray(self.load_chunk)
+        return {'bytes': sum(v.nbytes for v in vars(self).values() if isinstance(v, np.ndarray)),
+                'chunks': {s: int(np.sum(load_chunk == i)) for i, s in enumerate(states)}}
+
 
 class RectilinearGrid(Grid):
     """Rectilinear Grid
@@ -309,6 +388,16 @@ class RectilinearGrid(Grid):
         if isinstance(self, RectilinearSGrid):
             self.add_Sdepth_periodic_halo(zonal, meridional, halosize)
 
+    def compute_cell_edge_sizes(self):
+        """Returns the zonal and meridional cell edge sizes (see calc_cell_edge_sizes) as [ydim, xdim] arrays"""
+        dx = self._centred(np.diff(self.lon.astype(np.float64)), axis=0)
+        dy = self._centred(np.diff(self.lat.astype(np.float64)), axis=0)
+        dx, dy = np.broadcast_arrays(dx[np.newaxis, :], dy[:, np.newaxis])
+        if self.mesh == 'spherical':
+            deg2m = 1000. * 1.852 * 60.
+            return dx * deg2m * np.cos(np.radians(self.lat))[:, np.newaxis], dy * deg2m
+        return dx, dy
+
 
 class RectilinearZGrid(RectilinearGrid):
     """Rectilinear Z Grid
@@ -440,6 +529,62 @@ class CurvilinearGrid(Grid):
             self.meridional_halo = halosize
         if isinstance(self, CurvilinearSGrid):
             self.add_Sdepth_periodic_halo(zonal, meridional, halosize)
+        self.search_coefs = None
+
+    def set_search_coefs(self, use_search_coefs=True):
+        """Precompute, for each cell, the coefficients of the bilinear map from (xsi, eta) to (lon, lat), so that
+        the JIT index search only loads them instead of rebuilding them from the four corners at every iteration.
+        The table takes 11 doubles (88 bytes) per cell.
+
+        :param use_search_coefs: Boolean whether to use the coefficient table in JIT mode
+        """
+        self.use_search_coefs = use_search_coefs
+        if not use_search_coefs:
+            self.search_coefs = None
+        self.cstruct = None
+
+    def compute_search_coefs(self):
+        """Returns the [ydim-1, xdim-1, 11] table of bilinear inverse-map coefficients used by
+        search_indices_curvilinear: a[4] and b[4], with the longitudes of corners 1-3 unwrapped relative to
+        corner 0 on spherical meshes, and the position-independent parts of the quadratic's aa, bb and cc"""
+        lon = self.lon.astype(np.float64)
+        lat = self.lat.astype(np.float64)
+        x = [lon[:-1, :-1], lon[:-1, 1:], lon[1:, 1:], lon[1:, :-1]]
+        y = [lat[:-1, :-1], lat[:-1, 1:], lat[1:, 1:], lat[1:, :-1]]
+        if self.mesh == 'spherical':
+            for i in range(1, 4):
+                x[i] = np.where(x[i] < x[0] - 180, x[i] + 360, x[i])
+                x[i] = np.where(x[i] > x[0] + 180, x[i] - 360, x[i])
+        coefs = np.empty((self.ydim-1, self.xdim-1, 11), dtype=np.float64)
+        a = [x[0], -x[0] + x[1], -x[0] + x[3], x[0] - x[1] + x[2] - x[3]]
+        b = [y[0], -y[0] + y[1], -y[0] + y[3], y[0] - y[1] + y[2] - y[3]]
+        for i in range(4):
+            coefs[:, :, i] = a[i]
+            coefs[:, :, 4+i] = b[i]
+        coefs[:, :, 8] = a[3]*b[2] - a[2]*b[3]
+        coefs[:, :, 9] = a[3]*b[0] - a[0]*b[3] + a[1]*b[2] - a[2]*b[1]
+        coefs[:, :, 10] = a[1]*b[0] - a[0]*b[1]
+        return coefs
+
+    def compute_cell_edge_sizes(self):
+        """Returns the zonal and meridional cell edge sizes (see calc_cell_edge_sizes) as [ydim, xdim] arrays,
+        from the distances between neighbouring nodes along the grid lines. On spherical meshes these are
+        great-circle distances, with the same metres per degree as the GeographicPolar unit converter"""
+        lon = self.lon.astype(np.float64)
+        lat = self.lat.astype(np.float64)
+
+        def dist(axis):
+            dlon = np.diff(lon, axis=axis)
+            dlat = np.diff(lat, axis=axis)
+            if self.mesh != 'spherical':
+                return np.hypot(dlon, dlat)
+            dlon = (dlon + 180) % 360 - 180
+            lat0 = np.radians(lat.take(range(lat.shape[axis]-1), axis=axis))
+            lat1 = lat0 + np.radians(dlat)
+            h = np.sin(np.radians(dlat) / 2)**2 + np.cos(lat0) * np.cos(lat1) * np.sin(np.radians(dlon) / 2)**2
+            return 2 * np.arcsin(np.sqrt(np.minimum(h, 1))) * np.degrees(1000. * 1.852 * 60.)
+
+        return self._centred(dist(1), axis=1), self._centred(dist(0), axis=0)
 
 
 class CurvilinearZGrid(CurvilinearGrid):
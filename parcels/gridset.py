@@ -6,16 +6,21 @@ __all__ = ['GridSet']
 class GridSet(object):
     """GridSet class that holds the Grids on which the Fields are defined
 
+    Grids that only differ in their depth or time axes (e.g. NEMO T- and W-points, or 2D
+    and 3D fields on the same lon/lat mesh) remain separate Grids, but are linked to
+    the first Grid with that horizontal mesh (Grid.hgrid). In JIT mode, their horizontal
+    index search is then done only once per particle position.
     """
 
     def __init__(self):
         self.grids = []
+        self.hgrids = []
 
     def add_grid(self, field):
         grid = field.grid
         existing_grid = False
         for g in self.grids:
-            if field.chunksize == 'auto':
+            if field.chunksize in ['auto', 'native']:
                 break
             if g == grid:
                 existing_grid = True
@@ -43,8 +48,18 @@ class GridSet(object):
 
         if not existing_grid:
             self.grids.append(grid)
+            self.add_hgrid(grid)
         field.igrid = self.grids.index(field.grid)
 
+    def add_hgrid(self, grid):
+        """Links grid to the first Grid in the GridSet with the same horizontal mesh"""
+        for h in self.hgrids:
+            if h.same_horizontal_mesh(grid):
+                h.hgrid = h
+                grid.hgrid = h
+                return
+        self.hgrids.append(grid)
+
     def dimrange(self, dim):
         """Returns maximum value of a dimension (lon, lat, depth or time)
            on 'left' side and minimum value on 'right' side for all grids
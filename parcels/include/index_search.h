@@ -32,6 +32,14 @@ typedef struct
   void *grid;
 } CGrid;
 
+typedef struct
+{
+  int valid;
+  double x, y;
+  int xi, yi;
+  double xsi, eta;
+} CHorizontalSearch;  // last horizontal search on a mesh, shared by the grids that only differ in depth or time
+
 typedef struct
 {
   int xdim, ydim, zdim, tdim, z4d;
@@ -43,8 +51,12 @@ typedef struct
   float *lonlat_minmax;
   float *lon, *lat, *depth;
   double *time;
+  double *search_coefs;  // optional per-cell bilinear inverse-map coefficients (curvilinear grids only)
+  CHorizontalSearch *hsearch;
 } CStructuredGrid;
 
+#define NSEARCHCOEFS 11  // a[4], b[4] and the position-independent parts of aa, bb, cc
+
 
 typedef enum
   {
@@ -165,22 +177,16 @@ static inline void reconnect_bnd_indices(int *xi, int *yi, int xdim, int ydim, i
 }
 
 
-static inline StatusCode search_indices_rectilinear(type_coord x, type_coord y, type_coord z, CStructuredGrid *grid, GridCode gcode,
-                                                   int *xi, int *yi, int *zi, double *xsi, double *eta, double *zeta,
-                                                   int ti, double time, double t0, double t1, int interp_method,
-                                                   int gridindexingtype)
+static inline StatusCode search_indices_rectilinear(type_coord x, type_coord y, CStructuredGrid *grid,
+                                                   int *xi, int *yi, double *xsi, double *eta)
 {
   int xdim = grid->xdim;
   int ydim = grid->ydim;
-  int zdim = grid->zdim;
-  int tdim = grid->tdim;
   float *xvals = grid->lon;
   float *yvals = grid->lat;
-  float *zvals = grid->depth;
   float *xy_minmax = grid->lonlat_minmax;
   int sphere_mesh = grid->sphere_mesh;
   int zonal_periodic = grid->zonal_periodic;
-  int z4d = grid->z4d;
 
   if (zonal_periodic == 0){
     if ((xdim > 1) && ((x < xy_minmax[0]) || (x > xy_minmax[1])))
@@ -240,52 +246,22 @@ static inline StatusCode search_indices_rectilinear(type_coord x, type_coord y,
     while (*yi > 0 && y < yvals[*yi]) --(*yi);
     *eta = (y - yvals[*yi]) / (yvals[*yi+1] - yvals[*yi]);
   }
-
-  StatusCode status;
-  if (zdim > 1){
-    switch(gcode){
-      case RECTILINEAR_Z_GRID:
-        status = search_indices_vertical_z(z, zdim, zvals, zi, zeta, gridindexingtype);
-        break;
-      case RECTILINEAR_S_GRID:
-        status = search_indices_vertical_s(z, xdim, ydim, zdim, zvals,
-                                        *xi, *yi, zi, *xsi, *eta, zeta,
-                                        z4d, ti, tdim, time, t0, t1, interp_method);
-        break;
-      default:
-        status = ERROR_INTERPOLATION;
-    }
-    CHECKSTATUS(status);
-  }
-  else
-    *zeta = 0;
-
-  if ( (*xsi < 0) || (*xsi > 1) ) return ERROR_INTERPOLATION;
-  if ( (*eta < 0) || (*eta > 1) ) return ERROR_INTERPOLATION;
-  if ( (*zeta < 0) || (*zeta > 1) ) return ERROR_INTERPOLATION;
-
   return SUCCESS;
 }
 
 
-static inline StatusCode search_indices_curvilinear(type_coord x, type_coord y, type_coord z, CStructuredGrid *grid, GridCode gcode,
-                                                   int *xi, int *yi, int *zi, double *xsi, double *eta, double *zeta,
-                                                   int ti, double time, double t0, double t1, int interp_method,
-                                                   int gridindexingtype)
+static inline StatusCode search_indices_curvilinear(type_coord x, type_coord y, CStructuredGrid *grid,
+                                                   int *xi, int *yi, double *xsi, double *eta)
 {
   int xi_old = *xi;
   int yi_old = *yi;
   int xdim = grid->xdim;
   int ydim = grid->ydim;
-  int zdim = grid->zdim;
-  int tdim = grid->tdim;
   float *xvals = grid->lon;
   float *yvals = grid->lat;
-  float *zvals = grid->depth;
   float *xy_minmax = grid->lonlat_minmax;
   int sphere_mesh = grid->sphere_mesh;
   int zonal_periodic = grid->zonal_periodic;
-  int z4d = grid->z4d;
 
   // NEMO convention
   float (* xgrid)[xdim] = (float (*)[xdim]) xvals;
@@ -301,35 +277,60 @@ static inline StatusCode search_indices_curvilinear(type_coord x, type_coord y,
     return ERROR_OUT_OF_BOUNDS;
 
   double a[4], b[4];
+  double ygrid_loc[4];
+  double aa, bb, cc;
 
   *xsi = *eta = -1;
   int maxIterSearch = 1e6, it = 0;
   double tol = 1e-10;
   while ( (*xsi < -tol) || (*xsi > 1+tol) || (*eta < -tol) || (*eta > 1+tol) ){
-    double xgrid_loc[4] = {xgrid[*yi][*xi], xgrid[*yi][*xi+1], xgrid[*yi+1][*xi+1], xgrid[*yi+1][*xi]};
-    if (sphere_mesh){ //we are on the sphere
-      int i4;
-      if (xgrid_loc[0] < x - 225) xgrid_loc[0] += 360;
-      if (xgrid_loc[0] > x + 225) xgrid_loc[0] -= 360;
-      for (i4 = 1; i4 < 4; ++i4){
-        if (xgrid_loc[i4] < xgrid_loc[0] - 180) xgrid_loc[i4] += 360;
-        if (xgrid_loc[i4] > xgrid_loc[0] + 180) xgrid_loc[i4] -= 360;
+    if ((grid->search_coefs != NULL) && (*xi < xdim-1) && (*yi < ydim-1)){
+      // coefficients are pre-unwrapped relative to the first corner, so only that corner needs shifting
+      double *coefs = &grid->search_coefs[((size_t)(*yi)*(xdim-1) + *xi) * NSEARCHCOEFS];
+      double shift = 0;
+      if (sphere_mesh){
+        if (coefs[0] < x - 225) shift += 360;
+        if (coefs[0] + shift > x + 225) shift -= 360;
       }
+      a[0] = coefs[0] + shift; a[1] = coefs[1]; a[2] = coefs[2]; a[3] = coefs[3];
+      b[0] = coefs[4]; b[1] = coefs[5]; b[2] = coefs[6]; b[3] = coefs[7];
+      aa = coefs[8];
+      bb = coefs[9] - shift*b[3] + x*b[3] - y*a[3];
+      cc = coefs[10] - shift*b[1] + x*b[1] - y*a[1];
+      ygrid_loc[0] = b[0];
+      ygrid_loc[1] = b[0] + b[1];
+      ygrid_loc[2] = b[0] + b[1] + b[2] + b[3];
+      ygrid_loc[3] = b[0] + b[2];
+    }
+    else{
+      double xgrid_loc[4] = {xgrid[*yi][*xi], xgrid[*yi][*xi+1], xgrid[*yi+1][*xi+1], xgrid[*yi+1][*xi]};
+      if (sphere_mesh){ //we are on the sphere
+        int i4;
+        if (xgrid_loc[0] < x - 225) xgrid_loc[0] += 360;
+        if (xgrid_loc[0] > x + 225) xgrid_loc[0] -= 360;
+        for (i4 = 1; i4 < 4; ++i4){
+          if (xgrid_loc[i4] < xgrid_loc[0] - 180) xgrid_loc[i4] += 360;
+          if (xgrid_loc[i4] > xgrid_loc[0] + 180) xgrid_loc[i4] -= 360;
+        }
+      }
+      ygrid_loc[0] = ygrid[*yi][*xi];
+      ygrid_loc[1] = ygrid[*yi][*xi+1];
+      ygrid_loc[2] = ygrid[*yi+1][*xi+1];
+      ygrid_loc[3] = ygrid[*yi+1][*xi];
+
+      a[0] =  xgrid_loc[0];
+      a[1] = -xgrid_loc[0]    + xgrid_loc[1];
+      a[2] = -xgrid_loc[0]                                              + xgrid_loc[3];
+      a[3] =  xgrid_loc[0]    - xgrid_loc[1]      + xgrid_loc[2]        - xgrid_loc[3];
+      b[0] =  ygrid_loc[0];
+      b[1] = -ygrid_loc[0]    + ygrid_loc[1];
+      b[2] = -ygrid_loc[0]                                              + ygrid_loc[3];
+      b[3] =  ygrid_loc[0]    - ygrid_loc[1]      + ygrid_loc[2]        - ygrid_loc[3];
+
+      aa = a[3]*b[2] - a[2]*b[3];
+      bb = a[3]*b[0] - a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + x*b[3] - y*a[3];
+      cc = a[1]*b[0] - a[0]*b[1] + x*b[1] - y*a[1];
     }
-    double ygrid_loc[4] = {ygrid[*yi][*xi], ygrid[*yi][*xi+1], ygrid[*yi+1][*xi+1], ygrid[*yi+1][*xi]};
-
-    a[0] =  xgrid_loc[0];
-    a[1] = -xgrid_loc[0]    + xgrid_loc[1];
-    a[2] = -xgrid_loc[0]                                              + xgrid_loc[3];
-    a[3] =  xgrid_loc[0]    - xgrid_loc[1]      + xgrid_loc[2]        - xgrid_loc[3];
-    b[0] =  ygrid_loc[0];
-    b[1] = -ygrid_loc[0]    + ygrid_loc[1];
-    b[2] = -ygrid_loc[0]                                              + ygrid_loc[3];
-    b[3] =  ygrid_loc[0]    - ygrid_loc[1]      + ygrid_loc[2]        - ygrid_loc[3];
-
-    double aa = a[3]*b[2] - a[2]*b[3];
-    double bb = a[3]*b[0] - a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + x*b[3] - y*a[3];
-    double cc = a[1]*b[0] - a[0]*b[1] + x*b[1] - y*a[1];
     if (fabs(aa) < 1e-12)  // Rectilinear  cell, or quasi
       *eta = -cc / bb;
     else{
@@ -377,56 +378,96 @@ static inline StatusCode search_indices_curvilinear(type_coord x, type_coord y,
   if (*xsi > 1) *xsi = 1;
   if (*eta < 0) *eta = 0;
   if (*eta > 1) *eta = 1;
+  return SUCCESS;
+}
 
+/* Horizontal index search, which is done once per position for all grids on the same lon/lat mesh (see hsearch) */
+static inline StatusCode search_indices_horizontal(type_coord x, type_coord y, CStructuredGrid *grid,
+                                                  int *xi, int *yi, double *xsi, double *eta, GridCode gcode)
+{
   StatusCode status;
-  if (zdim > 1){
+  CHorizontalSearch *hsearch = grid->hsearch;
+  if ((hsearch != NULL) && hsearch->valid && (hsearch->x == x) && (hsearch->y == y)){
+    *xi = hsearch->xi;
+    *yi = hsearch->yi;
+    *xsi = hsearch->xsi;
+    *eta = hsearch->eta;
+  }
+  else{
     switch(gcode){
-      case CURVILINEAR_Z_GRID:
-        status = search_indices_vertical_z(z, zdim, zvals, zi, zeta, gridindexingtype);
+      case RECTILINEAR_Z_GRID:
+      case RECTILINEAR_S_GRID:
+        status = search_indices_rectilinear(x, y, grid, xi, yi, xsi, eta);
         break;
+      case CURVILINEAR_Z_GRID:
       case CURVILINEAR_S_GRID:
-        status = search_indices_vertical_s(z, xdim, ydim, zdim, zvals,
-                                        *xi, *yi, zi, *xsi, *eta, zeta,
-                                        z4d, ti, tdim, time, t0, t1, interp_method);
+        status = search_indices_curvilinear(x, y, grid, xi, yi, xsi, eta);
         break;
       default:
-        status = ERROR_INTERPOLATION;
+        printf("Only RECTILINEAR_Z_GRID, RECTILINEAR_S_GRID, CURVILINEAR_Z_GRID and CURVILINEAR_S_GRID grids are currently implemented\n");
+        return ERROR;
     }
     CHECKSTATUS(status);
+    if (hsearch != NULL){
+      hsearch->valid = 1;
+      hsearch->x = x;
+      hsearch->y = y;
+      hsearch->xi = *xi;
+      hsearch->yi = *yi;
+      hsearch->xsi = *xsi;
+      hsearch->eta = *eta;
+    }
   }
-  else
-    *zeta = 0;
-
-  if ( (*xsi < 0) || (*xsi > 1) ) return ERROR_INTERPOLATION;
-  if ( (*eta < 0) || (*eta > 1) ) return ERROR_INTERPOLATION;
-  if ( (*zeta < 0) || (*zeta > 1) ) return ERROR_INTERPOLATION;
-
   return SUCCESS;
 }
 
+/* Vertical index search in the column of horizontal cell (xi, yi) */
+static inline StatusCode search_indices_vertical(type_coord z, CStructuredGrid *grid, int xi, int yi, int *zi,
+                                                double xsi, double eta, double *zeta, GridCode gcode,
+                                                int ti, double time, double t0, double t1, int interp_method,
+                                                int gridindexingtype)
+{
+  switch(gcode){
+    case RECTILINEAR_Z_GRID:
+    case CURVILINEAR_Z_GRID:
+      return search_indices_vertical_z(z, grid->zdim, grid->depth, zi, zeta, gridindexingtype);
+    case RECTILINEAR_S_GRID:
+    case CURVILINEAR_S_GRID:
+      return search_indices_vertical_s(z, grid->xdim, grid->ydim, grid->zdim, grid->depth,
+                                       xi, yi, zi, xsi, eta, zeta,
+                                       grid->z4d, ti, grid->tdim, time, t0, t1, interp_method);
+    default:
+      return ERROR_INTERPOLATION;
+  }
+}
+
 /* Local linear search to update grid index
  * params ti, sizeT, time. t0, t1 are only used for 4D S grids
+ * The horizontal part of the search is shared by all grids on the same horizontal mesh (see GridSet.add_grid):
+ * if one of them was already searched at (x, y), its (xi, yi, xsi, eta) are reused and only the vertical search is done
  * */
 static inline StatusCode search_indices(type_coord x, type_coord y, type_coord z, CStructuredGrid *grid,
                                        int *xi, int *yi, int *zi, double *xsi, double *eta, double *zeta,
                                        GridCode gcode, int ti, double time, double t0, double t1, int interp_method,
                                        int gridindexingtype)
 {
-  switch(gcode){
-    case RECTILINEAR_Z_GRID:
-    case RECTILINEAR_S_GRID:
-      return search_indices_rectilinear(x, y, z, grid, gcode, xi, yi, zi, xsi, eta, zeta,
-                                   ti, time, t0, t1, interp_method, gridindexingtype);
-      break;
-    case CURVILINEAR_Z_GRID:
-    case CURVILINEAR_S_GRID:
-      return search_indices_curvilinear(x, y, z, grid, gcode, xi, yi, zi, xsi, eta, zeta,
-                                   ti, time, t0, t1, interp_method, gridindexingtype);
-      break;
-    default:
-      printf("Only RECTILINEAR_Z_GRID, RECTILINEAR_S_GRID, CURVILINEAR_Z_GRID and CURVILINEAR_S_GRID grids are currently implemented\n");
-      return ERROR;
+  StatusCode status;
+  status = search_indices_horizontal(x, y, grid, xi, yi, xsi, eta, gcode);
+  CHECKSTATUS(status);
+
+  if (grid->zdim > 1){
+    status = search_indices_vertical(z, grid, *xi, *yi, zi, *xsi, *eta, zeta, gcode,
+                                     ti, time, t0, t1, interp_method, gridindexingtype);
+    CHECKSTATUS(status);
   }
+  else
+    *zeta = 0;
+
+  if ( (*xsi < 0) || (*xsi > 1) ) return ERROR_INTERPOLATION;
+  if ( (*eta < 0) || (*eta > 1) ) return ERROR_INTERPOLATION;
+  if ( (*zeta < 0) || (*zeta > 1) ) return ERROR_INTERPOLATION;
+
+  return SUCCESS;
 }
 
 /* Local linear search to update time index */
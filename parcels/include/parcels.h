@@ -7,8 +7,10 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <math.h>
 #include <float.h>
+#include <time.h>
 #include "random.h"
 #include "index_search.h"
 #include "interpolation_utils.h"
@@ -17,6 +19,9 @@ extern "C" {
 #define max(X, Y) (((X) > (Y)) ? (X) : (Y))
 #define rtol 1.e-5
 #define atol 1.e-8
+#ifdef __TINYC__
+#define __builtin_prefetch(...)  // the Tiny C Compiler (in-memory JIT backend) has no prefetch builtin
+#endif
 
 typedef struct
 {
@@ -63,6 +68,113 @@ static inline bool is_zero_flt(float a) {
     return (fabs(a) <= FLT_EPSILON * fabs(a));
 }
 
+// clock for the sub-kernel profiling: the time stamp counter on x86, nanoseconds elsewhere
+static inline uint64_t profile_clock(void)
+{
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__TINYC__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+#endif
+}
+
+typedef enum
+  {
+    BOUNDARY_RECOVER=0, BOUNDARY_REFLECT=1, BOUNDARY_CLAMP=2, BOUNDARY_PERIODIC=3, BOUNDARY_DELETE=4, BOUNDARY_FREEZE=5
+  } BoundaryPolicy;
+
+/* Moves the (lon, lat, depth) position pos into box, which holds the (min, max) of lon, lat and depth, following
+ * a REFLECT, CLAMP or PERIODIC policy. Returns whether pos was changed */
+static inline int move_into_box(int policy, double *box, double pos[3])
+{
+  int i, moved = 0;
+  for (i = 0; i < 3; ++i){
+    double lo = box[2*i], hi = box[2*i+1], x = pos[i];
+    if (!(x < lo || x > hi))
+      continue;
+    if (policy == BOUNDARY_PERIODIC){
+      if (i == 2 || !(hi > lo) || isinf(hi - lo))
+        continue;
+      x = lo + fmod(x - lo, hi - lo);
+      if (x < lo)
+        x += hi - lo;
+    }
+    else if (policy == BOUNDARY_REFLECT)
+      x = (x < lo) ? 2*lo - x : 2*hi - x;
+    // reflected particles that overshoot by more than the width of the box end up on its edge
+    x = fmin(fmax(x, lo), hi);
+    moved |= (x != pos[i]);
+    pos[i] = x;
+  }
+  return moved;
+}
+
+static inline int is_moving_boundary_policy(int policy)
+{
+  return policy == BOUNDARY_REFLECT || policy == BOUNDARY_CLAMP || policy == BOUNDARY_PERIODIC;
+}
+
+/* Applies the boundary policy for error res (ERROR_OUT_OF_BOUNDS or ERROR_THROUGH_SURFACE) to the (lon, lat, depth)
+ * position pos of a particle that was reset to the start of its time step. box holds the (min, max) of lon, lat and depth.
+ * Returns REPEAT if the particle was moved back into the box, DELETE, SUCCESS for a frozen particle,
+ * or res if the policy does not resolve the error, so that it is left to the recovery kernels */
+static inline StatusCode apply_boundary_policy(StatusCode res, int *policies, double *box, double pos[3])
+{
+  int policy = policies[res == ERROR_THROUGH_SURFACE];
+  if (policy == BOUNDARY_DELETE)
+    return DELETE;
+  if (policy == BOUNDARY_FREEZE)
+    return SUCCESS;
+  if (!is_moving_boundary_policy(policy))
+    return res;
+  return move_into_box(policy, box, pos) ? REPEAT : res;
+}
+
+/* Whether a time step that failed with res, for a particle that started it at (lon, lat, depth), is repeated with
+ * its out-of-bounds field samples moved into box (see boundary_sample_position). That is the case if the policy
+ * for res moves positions and the particle started inside the box, so that the error came from a sample away from
+ * the particle, such as an intermediate Runge-Kutta stage */
+static inline int boundary_resample_step(StatusCode res, int *policies, double *box, double lon, double lat, double depth)
+{
+  double pos[3] = {lon, lat, depth};
+  if (res != ERROR_OUT_OF_BOUNDS && res != ERROR_THROUGH_SURFACE)
+    return 0;
+  if (!is_moving_boundary_policy(policies[res == ERROR_THROUGH_SURFACE]))
+    return 0;
+  return !move_into_box(BOUNDARY_CLAMP, box, pos);
+}
+
+/* Moves the position pos of a field sample that failed with err into box, following the boundary policy for err.
+ * Returns whether pos was changed, in which case the sample is taken again at pos */
+static inline int boundary_sample_position(StatusCode err, int *policies, double *box, double pos[3])
+{
+  int policy;
+  if (policies == NULL || (err != ERROR_OUT_OF_BOUNDS && err != ERROR_THROUGH_SURFACE))
+    return 0;
+  policy = policies[err == ERROR_THROUGH_SURFACE];
+  return is_moving_boundary_policy(policy) && move_into_box(policy, box, pos);
+}
+
+/* Applies the boundary policies to a particle that ended a successful time step at the (lon, lat, depth) position pos.
+ * If pos is outside box, a REFLECT, CLAMP or PERIODIC policy moves it into box and SUCCESS is returned. For DELETE
+ * and FREEZE, the error of a sample at pos is returned (ERROR_THROUGH_SURFACE above the top of box, ERROR_OUT_OF_BOUNDS
+ * otherwise), so that the time step is handled as a failed one by apply_boundary_policy */
+static inline StatusCode boundary_step_end(int *policies, double *box, double pos[3])
+{
+  double inside[3] = {pos[0], pos[1], pos[2]};
+  int surface = pos[2] < box[4];
+  int policy = policies[surface];
+  if (policy == BOUNDARY_RECOVER || !move_into_box(BOUNDARY_CLAMP, box, inside))
+    return SUCCESS;
+  if (is_moving_boundary_policy(policy)){
+    move_into_box(policy, box, pos);
+    return SUCCESS;
+  }
+  return surface ? ERROR_THROUGH_SURFACE : ERROR_OUT_OF_BOUNDS;
+}
+
 /* Bilinear interpolation routine for 2D grid */
 static inline StatusCode spatial_interpolation_bilinear(double xsi, double eta, float data[2][2], float *value)
 {
@@ -472,6 +584,103 @@ static inline StatusCode getCell3D(CField *f, int xi, int yi, int zi, int ti, fl
   return SUCCESS;
 }
 
+/* Software prefetch of the cell (xi, yi, zi) at time slices ti and ti+1, as cached by a particle's previous
+   field evaluation. Only issues loads for chunks that are already loaded, and never changes load_chunk */
+static inline void prefetch_cell(CField *f, int xi, int yi, int zi, int ti)
+{
+  CStructuredGrid *grid = f->grid->grid;
+  int *chunk_info = grid->chunk_info;
+  if (chunk_info == NULL || xi < 0 || yi < 0 || zi < 0 || ti < 0 ||
+      xi >= grid->xdim || yi >= grid->ydim || zi >= grid->zdim || ti >= grid->tdim)
+    return;
+  int ndim = chunk_info[0];
+  int block[3];
+  int ilocal[3];
+  int blockid, zdim, ydim, xdim, zlocal;
+  if (ndim == 2){
+    blockid = getBlock2D(chunk_info, yi, xi, block, ilocal);
+    zdim = 1;
+    zlocal = 0;
+    ydim = chunk_info[1+ndim+block[0]];
+    xdim = chunk_info[1+ndim+chunk_info[1]+block[1]];
+    ilocal[2] = ilocal[1];
+    ilocal[1] = ilocal[0];
+  }
+  else if (ndim == 3){
+    blockid = getBlock3D(chunk_info, zi, yi, xi, block, ilocal);
+    zdim = chunk_info[1+ndim+block[0]];
+    zlocal = ilocal[0];
+    ydim = chunk_info[1+ndim+chunk_info[1]+block[1]];
+    xdim = chunk_info[1+ndim+chunk_info[1]+chunk_info[2]+block[2]];
+  }
+  else
+    return;
+  if (grid->load_chunk[blockid] < 2 || f->data_chunks[blockid] == NULL)
+    return;
+
+  float *data = (float *) f->data_chunks[blockid];
+  int tii, zii;
+  for (tii=0; tii<2 && ti+tii<grid->tdim; ++tii){
+    for (zii=0; zii<2 && zlocal+zii<zdim; ++zii){
+      float *row = data + (((size_t)(ti+tii)*zdim + zlocal+zii)*ydim + ilocal[1])*xdim + ilocal[2];
+      __builtin_prefetch(row, 0, 1);
+      if (ilocal[1]+1 < ydim)
+        __builtin_prefetch(row+xdim, 0, 1);
+    }
+  }
+}
+
+
+/* Spatial interpolation of the cell data of one time slice, selecting the interpolation method and
+   the 2D or 3D variant of it */
+static inline StatusCode spatial_interpolation_cell(CStructuredGrid *grid, int zi, double xsi, double eta, double zeta,
+                                                   float data2D[2][2], float data3D[2][2][2], float *value,
+                                                   int interp_method, int gridindexingtype)
+{
+#define INTERP(fn_2d, fn_3d)                                            \
+  return (grid->zdim == 1) ? fn_2d(xsi, eta, data2D, value) : fn_3d(xsi, eta, zeta, data3D, value)
+
+  if ((interp_method == LINEAR) || (interp_method == CGRID_VELOCITY) ||
+      (interp_method == BGRID_VELOCITY) || (interp_method == BGRID_W_VELOCITY)) {
+    // adjust the normalised coordinate for flux-based interpolation methods
+    if ((interp_method == CGRID_VELOCITY) || (interp_method == BGRID_W_VELOCITY)) {
+      if ((gridindexingtype == NEMO)   || (gridindexingtype == MOM5) || (gridindexingtype == POP)) {
+        // velocity is on the northeast of a tracer cell
+        xsi = 1;
+        eta = 1;
+      } else if (gridindexingtype == MITGCM) {
+        // velocity is on the southwest of a tracer cell
+        xsi = 0;
+        eta = 0;
+      }
+    } else if (interp_method == BGRID_VELOCITY) {
+      if (gridindexingtype == MOM5) {
+        zeta = 1;
+      } else {
+        zeta = 0;
+      }
+    }
+    if ((gridindexingtype == MOM5) && (zi == -1)) {
+      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear_surface);
+    } else if ((gridindexingtype == POP) && (zi == grid->zdim-2)) {
+      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear_bottom);
+    } else {
+      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear);
+    }
+  } else if (interp_method == NEAREST) {
+    INTERP(spatial_interpolation_nearest2D, spatial_interpolation_nearest3D);
+  } else if ((interp_method == CGRID_TRACER) || (interp_method == BGRID_TRACER)) {
+    if ((gridindexingtype == POP) && (zi == grid->zdim-2)) {
+      INTERP(spatial_interpolation_tracer_bc_grid_2D, spatial_interpolation_tracer_bc_grid_bottom);
+    } else {
+      INTERP(spatial_interpolation_tracer_bc_grid_2D, spatial_interpolation_tracer_bc_grid_3D);
+    }
+  } else if (interp_method == LINEAR_INVDIST_LAND_TRACER) {
+    INTERP(spatial_interpolation_bilinear_invdist_land, spatial_interpolation_trilinear_invdist_land);
+  }
+  return ERROR;
+#undef INTERP
+}
 
 /* Linear interpolation along the time axis */
 static inline StatusCode temporal_interpolation_structured_grid(type_coord x, type_coord y, type_coord z, double time, CField *f,
@@ -524,70 +733,135 @@ static inline StatusCode temporal_interpolation_structured_grid(type_coord x, ty
     }
   }
 
-  // define a helper macro that will select the appropriate interpolation method
-  // depending on whether we need 2D or 3D
-#define INTERP(fn_2d, fn_3d)                                            \
-  do {                                                                  \
-    if (grid->zdim == 1) {                                              \
-      for (int i = 0; i < tii; i++) {                                   \
-        status = fn_2d(xsi, eta, data2D[i], &val[i]);                   \
-        CHECKSTATUS(status);                                            \
-      }                                                                 \
-    } else {                                                            \
-      for (int i = 0; i < tii; i++) {                                   \
-        status = fn_3d(xsi, eta, zeta, data3D[i], &val[i]);             \
-        CHECKSTATUS(status);                                            \
-      }                                                                 \
-    }                                                                   \
-  } while (0)
+  for (int i = 0; i < tii; i++) {
+    status = spatial_interpolation_cell(grid, zi[igrid], xsi, eta, zeta, data2D[i], data3D[i], &val[i],
+                                        interp_method, gridindexingtype);
+    CHECKSTATUS(status);
+  }
 
-  if ((interp_method == LINEAR) || (interp_method == CGRID_VELOCITY) ||
-      (interp_method == BGRID_VELOCITY) || (interp_method == BGRID_W_VELOCITY)) {
-    // adjust the normalised coordinate for flux-based interpolation methods
-    if ((interp_method == CGRID_VELOCITY) || (interp_method == BGRID_W_VELOCITY)) {
-      if ((gridindexingtype == NEMO)   || (gridindexingtype == MOM5) || (gridindexingtype == POP)) {
-        // velocity is on the northeast of a tracer cell
-        xsi = 1;
-        eta = 1;
-      } else if (gridindexingtype == MITGCM) {
-        // velocity is on the southwest of a tracer cell
-        xsi = 0;
-        eta = 0;
-      }
-    } else if (interp_method == BGRID_VELOCITY) {
-      if (gridindexingtype == MOM5) {
-        zeta = 1;
+  // tsrch = t0 in the case where val[1] isn't populated, so this
+  // gives the right interpolation in either case
+  *value = val[0] + (val[1] - val[0]) * (float)((tsrch - t0) / (t1 - t0));
+
+  return SUCCESS;
+}
+
+/* Vertical profile of a Field at (x, y): the time index and horizontal index searches are done once, after which
+   the Field is interpolated at the nz depths, or (if depths is NULL) at each of its nz depth levels, into values */
+static inline StatusCode column_interpolation_structured_grid(type_coord x, type_coord y, double time, CField *f,
+                                                             GridCode gcode, int *xi, int *yi, int *zi, int *ti,
+                                                             float *values, int nz, double *depths,
+                                                             int interp_method, int gridindexingtype)
+{
+  StatusCode status;
+  CStructuredGrid *grid = f->grid->grid;
+  int igrid = f->igrid;
+
+  if (f->time_periodic == 0 && f->allow_time_extrapolation == 0 && (time < grid->time[0] || time > grid->time[grid->tdim-1])){
+    return ERROR_TIME_EXTRAPOLATION;
+  }
+  status = search_time_index(&time, grid->tdim, grid->time, &ti[igrid], f->time_periodic, grid->tfull_min, grid->tfull_max, grid->periods); CHECKSTATUS(status);
+  int tii = (ti[igrid] < grid->tdim-1 && time > grid->time[ti[igrid]]) ? 2 : 1;
+  double t0 = grid->time[ti[igrid]];
+  double t1 = (tii == 2) ? grid->time[ti[igrid]+1] : t0+1;
+  double tsrch = (tii == 2) ? time : t0;
+
+  double xsi, eta, zeta = 0;
+  status = search_indices_horizontal(x, y, grid, &xi[igrid], &yi[igrid], &xsi, &eta, gcode); CHECKSTATUS(status);
+  if ((xsi < 0) || (xsi > 1) || (eta < 0) || (eta > 1)) return ERROR_INTERPOLATION;
+
+  float data2D[2][2][2];
+  float data3D[2][2][2][2];
+  float val[2] = {0.0f, 0.0f};
+  int i, k;
+  if (grid->zdim == 1){
+    status = getCell2D(f, xi[igrid], yi[igrid], ti[igrid], data2D, tii == 1); CHECKSTATUS(status);
+  }
+  for (k = 0; k < nz; k++){
+    if (grid->zdim > 1){
+      if (depths == NULL){
+        // depth level k, as the top of cell k (or the bottom of the last cell)
+        zi[igrid] = (k < grid->zdim-1) ? k : grid->zdim-2;
+        zeta = (k < grid->zdim-1) ? 0 : 1;
       } else {
-        zeta = 0;
+        status = search_indices_vertical(depths[k], grid, xi[igrid], yi[igrid], &zi[igrid], xsi, eta, &zeta, gcode,
+                                         ti[igrid], tsrch, t0, t1, interp_method, gridindexingtype);
+        CHECKSTATUS(status);
+        if ((zeta < 0) || (zeta > 1)) return ERROR_INTERPOLATION;
       }
+      int zc = zi[igrid];
+      if ((gridindexingtype == MOM5) && (zc == -1))
+        zc = 0;
+      else if ((gridindexingtype == POP) && (zc == grid->zdim-2))
+        zc = zc-1;
+      status = getCell3D(f, xi[igrid], yi[igrid], zc, ti[igrid], data3D, tii == 1); CHECKSTATUS(status);
     }
-    if ((gridindexingtype == MOM5) && (zi[igrid] == -1)) {
-      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear_surface);
-    } else if ((gridindexingtype == POP) && (zi[igrid] == grid->zdim-2)) {
-      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear_bottom);
-    } else {
-      INTERP(spatial_interpolation_bilinear, spatial_interpolation_trilinear);
-    }
-  } else if (interp_method == NEAREST) {
-    INTERP(spatial_interpolation_nearest2D, spatial_interpolation_nearest3D);
-  } else if ((interp_method == CGRID_TRACER) || (interp_method == BGRID_TRACER)) {
-    if ((gridindexingtype == POP) && (zi[igrid] == grid->zdim-2)) {
-      INTERP(spatial_interpolation_tracer_bc_grid_2D, spatial_interpolation_tracer_bc_grid_bottom);
-    } else {
-      INTERP(spatial_interpolation_tracer_bc_grid_2D, spatial_interpolation_tracer_bc_grid_3D);
+    if ((grid->zdim > 1) || (k == 0)){
+      for (i = 0; i < tii; i++){
+        status = spatial_interpolation_cell(grid, zi[igrid], xsi, eta, zeta, data2D[i], data3D[i], &val[i],
+                                            interp_method, gridindexingtype);
+        CHECKSTATUS(status);
+      }
     }
-  } else if (interp_method == LINEAR_INVDIST_LAND_TRACER) {
-    INTERP(spatial_interpolation_bilinear_invdist_land, spatial_interpolation_trilinear_invdist_land);
-  } else {
-    return ERROR;
+    values[k] = val[0] + (val[1] - val[0]) * (float)((tsrch - t0) / (t1 - t0));
   }
+  return SUCCESS;
+}
 
-  // tsrch = t0 in the case where val[1] isn't populated, so this
-  // gives the right interpolation in either case
-  *value = val[0] + (val[1] - val[0]) * (float)((tsrch - t0) / (t1 - t0));
+/* Cell (xi, yi, zi) of a dense static Field, whose data is a single block [zdim][ydim][xdim] that is always
+   loaded (see Field.dense), so that it is read without looking up chunks or their load state */
+static inline void getCellDense(CField *f, int xi, int yi, int zi, float cell_data[2][2][2])
+{
+  int xdim = f->xdim, ydim = f->ydim, zdim = f->zdim;
+  float (*data)[ydim][xdim] = (float (*)[ydim][xdim]) f->data_chunks[0];
+  int xiid = ((xdim==1) ? 0 : 1);
+  int yiid = ((ydim==1) ? 0 : 1);
+  int ziid = ((zdim==1) ? 0 : 1);
+  int zii, yii, xii;
+  for (zii=0; zii<2; zii++)
+    for (yii=0; yii<2; yii++)
+      for (xii=0; xii<2; xii++)
+        cell_data[zii][yii][xii] = data[zi+(zii*ziid)][yi+(yii*yiid)][xi+(xii*xiid)];
+}
 
-  return SUCCESS;
-#undef INTERP
+/* Interpolation of a static Field (see Field.static), which has a single time slice: no time index
+   search or temporal interpolation. A dense Field is read with getCellDense(), a chunked one
+   with the load_chunk aware getCell2D/getCell3D */
+static inline StatusCode static_interpolation_structured_grid(type_coord x, type_coord y, type_coord z, CField *f,
+                                                             GridCode gcode, int *xi, int *yi, int *zi,
+                                                             float *value, int interp_method, int gridindexingtype,
+                                                             int dense)
+{
+  StatusCode status;
+  CStructuredGrid *grid = f->grid->grid;
+  int igrid = f->igrid;
+  double xsi, eta, zeta;
+  double t0 = grid->time[0];
+
+  float data2D[2][2][2];
+  float data3D[2][2][2][2];
+
+  status = search_indices(x, y, z, grid, &xi[igrid], &yi[igrid], &zi[igrid],
+                          &xsi, &eta, &zeta, gcode, 0, t0, t0, t0+1, interp_method, gridindexingtype);
+  CHECKSTATUS(status);
+
+  int zc = zi[igrid];
+  if ((gridindexingtype == MOM5) && (zc == -1))
+    zc = 0;
+  else if ((gridindexingtype == POP) && (zc == grid->zdim-2))
+    zc = zc-1;
+
+  float (*cell2D)[2] = data2D[0];
+  if (dense) {
+    getCellDense(f, xi[igrid], yi[igrid], (grid->zdim == 1) ? 0 : zc, data3D[0]);
+    cell2D = data3D[0][0];
+  } else if (grid->zdim == 1) {
+    status = getCell2D(f, xi[igrid], yi[igrid], 0, data2D, 1); CHECKSTATUS(status);
+  } else {
+    status = getCell3D(f, xi[igrid], yi[igrid], zc, 0, data3D, 1); CHECKSTATUS(status);
+  }
+  return spatial_interpolation_cell(grid, zi[igrid], xsi, eta, zeta, cell2D, data3D[0], value,
+                                    interp_method, gridindexingtype);
 }
 
 static double dist(double lon1, double lon2, double lat1, double lat2, int sphere_mesh, double lat)
@@ -980,6 +1254,46 @@ static inline StatusCode temporal_interpolation_pstruct(type_coord x, type_coord
   return temporal_interpolation(x, y, z, time, f, xi, yi, zi, ti, value, interp_method, gridindexingtype);
 }
 
+static inline StatusCode static_interpolation(type_coord x, type_coord y, type_coord z, CField *f,
+                                             int *xi, int *yi, int *zi,
+                                             float *value, int interp_method, int gridindexingtype, int dense)
+{
+  CGrid *_grid = f->grid;
+  GridCode gcode = _grid->gtype;
+
+  if (gcode == RECTILINEAR_Z_GRID || gcode == RECTILINEAR_S_GRID || gcode == CURVILINEAR_Z_GRID || gcode == CURVILINEAR_S_GRID)
+    return static_interpolation_structured_grid(x, y, z, f, gcode, xi, yi, zi, value, interp_method, gridindexingtype, dense);
+  else{
+    printf("Only RECTILINEAR_Z_GRID, RECTILINEAR_S_GRID, CURVILINEAR_Z_GRID and CURVILINEAR_S_GRID grids are currently implemented\n");
+    return ERROR;
+  }
+}
+
+static inline StatusCode static_interpolation_pstruct(type_coord x, type_coord y, type_coord z, CField *f,
+                                                      void *vxi, void *vyi, void *vzi,
+                                                      float *value, int interp_method, int gridindexingtype, int dense)
+{
+  int *xi = (int *) vxi;
+  int *yi = (int *) vyi;
+  int *zi = (int *) vzi;
+  return static_interpolation(x, y, z, f, xi, yi, zi, value, interp_method, gridindexingtype, dense);
+}
+
+static inline StatusCode column_interpolation(type_coord x, type_coord y, double time, CField *f,
+                                             int *xi, int *yi, int *zi, int *ti, float *values, int nz, double *depths,
+                                             int interp_method, int gridindexingtype)
+{
+  CGrid *_grid = f->grid;
+  GridCode gcode = _grid->gtype;
+
+  if (gcode == RECTILINEAR_Z_GRID || gcode == RECTILINEAR_S_GRID || gcode == CURVILINEAR_Z_GRID || gcode == CURVILINEAR_S_GRID)
+    return column_interpolation_structured_grid(x, y, time, f, gcode, xi, yi, zi, ti, values, nz, depths, interp_method, gridindexingtype);
+  else{
+    printf("Only RECTILINEAR_Z_GRID, RECTILINEAR_S_GRID, CURVILINEAR_Z_GRID and CURVILINEAR_S_GRID grids are currently implemented\n");
+    return ERROR;
+  }
+}
+
 static inline StatusCode temporal_interpolationUV(type_coord x, type_coord y, type_coord z, double time,
                                                  CField *U, CField *V,
                                                  int *xi, int *yi, int *zi, int *ti,
@@ -1044,6 +1358,164 @@ static inline StatusCode temporal_interpolationUVW_pstruct(type_coord x, type_co
   return temporal_interpolationUVW(x, y, z, time, U, V, W, xi, yi, zi, ti, valueU, valueV, valueW, interp_method, gridindexingtype);
 }
 
+/* Coordinates of the corners of cell (xi, yi), counter-clockwise from (xi, yi),
+ * with the longitudes unwrapped relative to the first corner on spherical meshes */
+static inline void index_space_corners(CStructuredGrid *grid, GridCode gcode, int xi, int yi, double *px, double *py)
+{
+  int xdim = grid->xdim;
+  if (gcode == RECTILINEAR_Z_GRID || gcode == RECTILINEAR_S_GRID){
+    px[0] = px[3] = grid->lon[xi];
+    px[1] = px[2] = grid->lon[xi+1];
+    py[0] = py[1] = grid->lat[yi];
+    py[2] = py[3] = grid->lat[yi+1];
+  }
+  else{
+    float (* xgrid)[xdim] = (float (*)[xdim]) grid->lon;
+    float (* ygrid)[xdim] = (float (*)[xdim]) grid->lat;
+    px[0] = xgrid[yi][xi]; px[1] = xgrid[yi][xi+1]; px[2] = xgrid[yi+1][xi+1]; px[3] = xgrid[yi+1][xi];
+    py[0] = ygrid[yi][xi]; py[1] = ygrid[yi][xi+1]; py[2] = ygrid[yi+1][xi+1]; py[3] = ygrid[yi+1][xi];
+  }
+  if (grid->sphere_mesh){
+    int i4;
+    for (i4 = 1; i4 < 4; ++i4){
+      if (px[i4] - px[0] > 180) px[i4] -= 360;
+      if (px[0] - px[i4] > 180) px[i4] += 360;
+    }
+  }
+}
+
+/* Position of the continuous grid index (gx, gy), extrapolated from the nearest cell outside of the grid.
+ * On spherical meshes the longitude is shifted to within 180 degrees of lon */
+static inline void index_space_position(CStructuredGrid *grid, GridCode gcode, double gx, double gy, double lon,
+                                        double *x, double *y)
+{
+  int xi = min(max((int) floor(gx), 0), grid->xdim-2);
+  int yi = min(max((int) floor(gy), 0), grid->ydim-2);
+  double px[4], py[4], phi[4];
+  index_space_corners(grid, gcode, xi, yi, px, py);
+  phi2D_lin(gx - xi, gy - yi, phi);
+  *x = dot_prod(px, phi, 4);
+  *y = dot_prod(py, phi, 4);
+  if (grid->sphere_mesh)
+    *x += 360 * round((lon - *x) / 360.);
+}
+
+/* Velocity of U and V (on the same A-grid) at the continuous grid index (gx, gy), in cells per second:
+ * interpolated bilinearly in the cell and converted through the inverse of the cell Jacobian */
+static inline StatusCode index_space_velocity(CField *U, CField *V, double time, double gx, double gy, int *ti,
+                                              double *dgx, double *dgy)
+{
+  StatusCode status;
+  CStructuredGrid *grid = U->grid->grid;
+  int igrid = U->igrid;
+  if ((gx < 0) || (gx > grid->xdim-1) || (gy < 0) || (gy > grid->ydim-1))
+    return ERROR_OUT_OF_BOUNDS;
+  int xi = min((int) floor(gx), grid->xdim-2);
+  int yi = min((int) floor(gy), grid->ydim-2);
+  double xsi = gx - xi;
+  double eta = gy - yi;
+
+  if (U->time_periodic == 0 && U->allow_time_extrapolation == 0 && (time < grid->time[0] || time > grid->time[grid->tdim-1])){
+    return ERROR_TIME_EXTRAPOLATION;
+  }
+  status = search_time_index(&time, grid->tdim, grid->time, &ti[igrid], U->time_periodic, grid->tfull_min, grid->tfull_max, grid->periods); CHECKSTATUS(status);
+  int tii = (ti[igrid] < grid->tdim-1 && time > grid->time[ti[igrid]]) ? 2 : 1;
+  double t0 = grid->time[ti[igrid]];
+  double t1 = (tii == 2) ? grid->time[ti[igrid]+1] : t0+1;
+  double tsrch = (tii == 2) ? time : t0;
+
+  float dataU[2][2][2], dataV[2][2][2];
+  float u[2] = {0.0f, 0.0f};
+  float v[2] = {0.0f, 0.0f};
+  status = getCell2D(U, xi, yi, ti[igrid], dataU, tii == 1); CHECKSTATUS(status);
+  status = getCell2D(V, xi, yi, ti[igrid], dataV, tii == 1); CHECKSTATUS(status);
+  int i;
+  for (i = 0; i < tii; i++){
+    status = spatial_interpolation_bilinear(xsi, eta, dataU[i], &u[i]); CHECKSTATUS(status);
+    status = spatial_interpolation_bilinear(xsi, eta, dataV[i], &v[i]); CHECKSTATUS(status);
+  }
+  double uval = u[0] + (u[1] - u[0]) * ((tsrch - t0) / (t1 - t0));
+  double vval = v[0] + (v[1] - v[0]) * ((tsrch - t0) / (t1 - t0));
+
+  // the 2D Jacobian is the horizontal part of the one of the prism with the cell as top and bottom face
+  double px[8], py[8], pz[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  double jacM[9];
+  index_space_corners(grid, U->grid->gtype, xi, yi, px, py);
+  for (i = 0; i < 4; i++){
+    px[i+4] = px[i];
+    py[i+4] = py[i];
+  }
+  dxdxsi3D_lin(px, py, pz, xsi, eta, 0, jacM, grid->sphere_mesh);
+  double jac = jacM[3*0+0]*jacM[3*1+1] - jacM[3*0+1]*jacM[3*1+0];
+  if (jac == 0)
+    return ERROR_INTERPOLATION;
+  *dgx = (jacM[3*1+1]*uval - jacM[3*0+1]*vval) / jac;
+  *dgy = (jacM[3*0+0]*vval - jacM[3*1+0]*uval) / jac;
+  return SUCCESS;
+}
+
+/* Fourth-order Runge-Kutta step of dt in the index space of the grid of U.
+ * The particle keeps its cell in (xi, yi) and its position in the cell in (xsi, eta), so no index search is done
+ * while it is advected in index space; lon and lat are materialised after the step.
+ * The index search is only done when (xi, yi, xsi, eta) does not materialise to (lon, lat) anymore, compared in
+ * single precision so that this holds for both float and double particle coordinates */
+static inline StatusCode advection_rk4_index_space(CField *U, CField *V, double time, double dt,
+                                                   int *xi, int *yi, int *ti, double *xsi, double *eta,
+                                                   double *lon, double *lat)
+{
+  StatusCode status;
+  CStructuredGrid *grid = U->grid->grid;
+  GridCode gcode = U->grid->gtype;
+  int igrid = U->igrid;
+  double x, y;
+
+  int valid = (xi[igrid] >= 0) && (xi[igrid] < grid->xdim-1) && (yi[igrid] >= 0) && (yi[igrid] < grid->ydim-1) &&
+              (*xsi >= 0) && (*xsi <= 1) && (*eta >= 0) && (*eta <= 1);
+  if (valid){
+    index_space_position(grid, gcode, xi[igrid] + *xsi, yi[igrid] + *eta, *lon, &x, &y);
+    valid = ((float) x == (float) *lon) && ((float) y == (float) *lat);  // in the precision of float coordinates
+  }
+  if (!valid){
+    xi[igrid] = min(max(xi[igrid], 0), grid->xdim-2);
+    yi[igrid] = min(max(yi[igrid], 0), grid->ydim-2);
+    if (gcode == RECTILINEAR_Z_GRID || gcode == RECTILINEAR_S_GRID)
+      status = search_indices_rectilinear(*lon, *lat, grid, &xi[igrid], &yi[igrid], xsi, eta);
+    else
+      status = search_indices_curvilinear(*lon, *lat, grid, &xi[igrid], &yi[igrid], xsi, eta);
+    CHECKSTATUS(status);
+  }
+  double gx = xi[igrid] + *xsi;
+  double gy = yi[igrid] + *eta;
+
+  double u1, v1, u2, v2, u3, v3, u4, v4;
+  status = index_space_velocity(U, V, time, gx, gy, ti, &u1, &v1); CHECKSTATUS(status);
+  status = index_space_velocity(U, V, time + .5*dt, gx + u1*.5*dt, gy + v1*.5*dt, ti, &u2, &v2); CHECKSTATUS(status);
+  status = index_space_velocity(U, V, time + .5*dt, gx + u2*.5*dt, gy + v2*.5*dt, ti, &u3, &v3); CHECKSTATUS(status);
+  status = index_space_velocity(U, V, time + dt, gx + u3*dt, gy + v3*dt, ti, &u4, &v4); CHECKSTATUS(status);
+  gx += (u1 + 2*u2 + 2*u3 + u4) / 6. * dt;
+  gy += (v1 + 2*v2 + 2*v3 + v4) / 6. * dt;
+
+  // a position outside of the grid is kept (extrapolated) so that the next step returns the out-of-bounds error
+  xi[igrid] = min(max((int) floor(gx), 0), grid->xdim-2);
+  yi[igrid] = min(max((int) floor(gy), 0), grid->ydim-2);
+  *xsi = gx - xi[igrid];
+  *eta = gy - yi[igrid];
+  index_space_position(grid, gcode, gx, gy, *lon, &x, &y);
+  *lon = x;
+  *lat = y;
+  return SUCCESS;
+}
+
+static inline StatusCode advection_rk4_index_space_pstruct(CField *U, CField *V, double time, double dt,
+                                                           void *vxi, void *vyi, void *vti, double *xsi, double *eta,
+                                                           double *lon, double *lat)
+{
+  int *xi = (int *) vxi;
+  int *yi = (int *) vyi;
+  int *ti = (int *) vti;
+  return advection_rk4_index_space(U, V, time, dt, xi, yi, ti, xsi, eta, lon, lat);
+}
+
 
 
 #ifdef __cplusplus
@@ -1,7 +1,11 @@
 import re
 import _ctypes
+from collections import OrderedDict
+from ctypes import c_uint64
+from ctypes import c_void_p
 import inspect
 import numpy.ctypeslib as npct
+from time import perf_counter
 from time import time as ostime
 from os import path
 from os import remove
@@ -9,6 +13,7 @@ from sys import platform
 from sys import version_info
 from ast import FunctionDef
 from hashlib import md5
+import dask.array as da
 from parcels.tools.loggers import logger
 import numpy as np
 from numpy import ndarray
@@ -19,6 +24,8 @@ except:
     MPI = None
 
 from parcels.tools.global_statics import get_cache_dir
+from parcels.compilation.codegenerator import ProfileSectionNode
+from parcels.compilation.codecompiler import InMemoryLibrary
 
 # === import just necessary field classes to perform setup checks === #
 from parcels.field import Field
@@ -29,8 +36,12 @@ from parcels.grid import GridCode
 from parcels.field import FieldOutOfBoundError
 from parcels.field import FieldOutOfBoundSurfaceError
 from parcels.field import TimeExtrapolationError
+from parcels.tools.converters import Geographic, GeographicPolar, UnitConverter
 from parcels.tools.statuscodes import StateCode, OperationCode, ErrorCode
+from parcels.tools.tracing import tracer
+from parcels.kernel import boundary
 from parcels.application_kernels.advection import AdvectionRK4_3D
+from parcels.application_kernels.advection import AdvectionRK4_IndexSpace
 from parcels.application_kernels.advection import AdvectionAnalytical
 
 __all__ = ['BaseKernel']
@@ -47,6 +58,14 @@ class BaseKernel(object):
     :arg pyfunc: (aggregated) Kernel function
     :arg funcname: function name
     :param delete_cfiles: Boolean whether to delete the C-files after compilation in JIT mode (default is True)
+    :param prefetch_distance: Number of particles ahead for which the JIT loop prefetches the field cells
+           that those particles sampled last (default is 0, no prefetching)
+    :param profile: Boolean whether the JIT code counts the time and calls of each sub-kernel of a
+           merged kernel, see profile_breakdown() (default is False)
+    :param subkernels: List of (name, number of statements) of the sub-kernels whose bodies make up py_ast,
+           as set by merge(). Default is the kernel function itself
+    :param memory_budget: Maximum number of bytes of chunked field data that the JIT loop keeps loaded; particles
+           are then advanced in groups by the chunks they are in, see ChunkScheduler (default is None, no budget)
 
     Note: A Kernel is either created from a compiled <function ...> object
     or the necessary information (funcname, funccode, funcvars) is provided.
@@ -59,13 +78,21 @@ class BaseKernel(object):
     funcname = None
 
     def __init__(self, fieldset, ptype, pyfunc=None, funcname=None, funccode=None, py_ast=None, funcvars=None,
-                 c_include="", delete_cfiles=True):
+                 c_include="", delete_cfiles=True,
+                 prefetch_distance=0, profile=False, subkernels=None, memory_budget=None):
         self._fieldset = fieldset
         self.field_args = None
         self.const_args = None
         self._ptype = ptype
         self._lib = None
         self.delete_cfiles = delete_cfiles
+        self.prefetch_distance = prefetch_distance
+        self.profile = profile
+        self.subkernels = subkernels
+        self.memory_budget = memory_budget
+        if profile and not ptype.uses_jit:
+            logger.warning_once("Kernel profiling is only available in JIT mode")
+        self._profile_wall = 0.
         self._cleanup_files = None
         self._cleanup_lib = None
         self._c_include = c_include
@@ -155,6 +182,22 @@ class BaseKernel(object):
                 if warning:
                     logger.warning_once('Note that in AdvectionRK4_3D, vertical velocity is assumed positive towards increasing z.\n'
                                         '  If z increases downward and w is positive upward you can re-orient it downwards by setting fieldset.W.set_scaling_factor(-1.)')
+            elif pyfunc is AdvectionRK4_IndexSpace:
+                for var in ['xsi', 'eta']:
+                    if var not in [v.name for v in self._ptype.variables] or \
+                            [v.dtype for v in self._ptype.variables if v.name == var][0] != np.float64:
+                        raise NotImplementedError("Index-space advection needs a particle class with Variable('%s', dtype=np.float64)" % var)
+                U, V = self._fieldset.U, self._fieldset.V
+                if not (isinstance(U, Field) and isinstance(V, Field)) or U.interp_method != 'linear' or V.grid is not U.grid:
+                    raise NotImplementedError('Index-space advection only works with U and V on the same A-grid')
+                if U.grid.zdim > 1 or U.grid.xdim < 2 or U.grid.ydim < 2:
+                    raise NotImplementedError('Index-space advection only works with 2D fields')
+                if U.grid.mesh == 'spherical':
+                    default_units = type(U.units) is GeographicPolar and type(V.units) is Geographic
+                else:
+                    default_units = type(U.units) is UnitConverter and type(V.units) is UnitConverter
+                if not default_units:
+                    raise NotImplementedError('Index-space advection only works with the default unit conversion of the mesh')
             elif pyfunc is AdvectionAnalytical:
                 if self._ptype.uses_jit:
                     raise NotImplementedError('Analytical Advection only works in Scipy mode')
@@ -211,9 +254,10 @@ class BaseKernel(object):
             mpi_rank = mpi_comm.Get_rank()
             cache_name = self._cache_key  # only required here because loading is done by Kernel class instead of Compiler class
             dyn_dir = get_cache_dir() if mpi_rank == 0 else None
-            dyn_dir = mpi_comm.bcast(dyn_dir, root=0)
             basename = cache_name if mpi_rank == 0 else None
-            basename = mpi_comm.bcast(basename, root=0)
+            with tracer.span('MPI bcast', 'mpi'):
+                dyn_dir = mpi_comm.bcast(dyn_dir, root=0)
+                basename = mpi_comm.bcast(basename, root=0)
             basename = basename + "_%d" % mpi_rank
         else:
             cache_name = self._cache_key  # only required here because loading is done by Kernel class instead of Compiler class
@@ -232,7 +276,18 @@ class BaseKernel(object):
         return src_file_or_files, lib_file, log_file
 
     def compile(self, compiler):
-        """ Writes kernel code to file and compiles it."""
+        """ Writes kernel code to file and compiles it, or compiles it from memory with an in-memory compiler
+        (see TCCCompiler), which falls back to its fallback compiler if the in-memory compilation fails"""
+        tic = tracer.now()
+        if getattr(compiler, 'in_memory', False):
+            try:
+                self._lib = compiler.compile_source(self.ccode)
+                logger.info("Compiled %s in memory" % self.name)
+                tracer.add_span('compile', 'kernel', tic, kernel=self.name, in_memory=True)
+                return
+            except RuntimeError as e:
+                logger.warning("In-memory compilation of %s failed, compiling it to file instead. %s" % (self.name, e))
+                compiler = compiler.fallback
         all_files_array = []
         if self.src_file is None:
             if self.dyn_srcs is not None:
@@ -252,10 +307,75 @@ class BaseKernel(object):
             logger.info("Compiled %s ==> %s" % (self.name, self.lib_file))
             if self.log_file is not None:
                 all_files_array.append(self.log_file)
+        tracer.add_span('compile', 'kernel', tic, kernel=self.name)
 
     def load_lib(self):
-        self._lib = npct.load_library(self.lib_file, '.')
+        if not isinstance(self._lib, InMemoryLibrary):
+            self._lib = npct.load_library(self.lib_file, '.')
         self._function = self._lib.particle_loop
+        self._profile_wall = 0.
+
+    def add_profile_sections(self, py_ast):
+        """Inserts a ProfileSectionNode at the start of each sub-kernel body of py_ast (in place)"""
+        if self.subkernels is None:
+            self.subkernels = [(self.funcname, len(py_ast.body))]
+        start = 0
+        body = []
+        for i, (_, nstmts) in enumerate(self.subkernels):
+            body += [ProfileSectionNode(i)] + py_ast.body[start:start + nstmts]
+            start += nstmts
+        py_ast.body = body + py_ast.body[start:]
+        return py_ast
+
+    def call_jit(self, *args):
+        """Calls the particle_loop() of the JIT library, timing it if the kernel is profiled or traced"""
+        if not (self.profile or tracer.enabled):
+            return self._function(*args)
+        tic = perf_counter()
+        res = self._function(*args)
+        toc = perf_counter()
+        if self.profile:
+            self._profile_wall += toc - tic
+        tracer.add_span('execute_jit', 'kernel', tic, toc, kernel=self.name, particles=args[0].value)
+        return res
+
+    def lib_variable(self, ctype, name):
+        """Global variable name of the compiled kernel as an instance of ctype"""
+        if isinstance(self._lib, InMemoryLibrary):
+            return self._lib.in_dll(ctype, name)
+        return ctype.in_dll(self._lib, name)
+
+    def profile_breakdown(self):
+        """Time and number of calls of each sub-kernel of a profiled JIT kernel, accumulated over all
+        executions since it was compiled. The clock ticks counted in the JIT code are converted to seconds
+        with the wall-clock time of the whole particle loop, which also includes the loop itself
+        (reported as '(loop)') and the recovery of particles in C.
+
+        :return: OrderedDict of sub-kernel name (with a #i suffix for repeated names) to a dictionary with
+                 'calls', 'time' (in s) and 'fraction' (of the time of the particle loop)
+        """
+        if not self.profile or self._lib is None:
+            raise RuntimeError("Kernel %s is not a compiled profiled kernel; create it with profile=True in JIT mode" % self.funcname)
+        n = len(self.subkernels)
+        cycles = np.ctypeslib.as_array(self.lib_variable(c_uint64 * n, 'parcels_profile_cycles')).astype(np.float64)
+        calls = np.ctypeslib.as_array(self.lib_variable(c_uint64 * n, 'parcels_profile_calls'))
+        loop_cycles = float(self.lib_variable(c_uint64, 'parcels_profile_loop_cycles').value)
+        scale = self._profile_wall / loop_cycles if loop_cycles > 0 else 0.
+        breakdown = OrderedDict()
+        for i, (name, _) in enumerate(self.subkernels):
+            if name in breakdown:
+                name = '%s#%d' % (name, i)
+            breakdown[name] = {'calls': int(calls[i]), 'time': cycles[i] * scale,
+                               'fraction': cycles[i] / loop_cycles if loop_cycles > 0 else 0.}
+        breakdown['(loop)'] = {'calls': 0, 'time': (loop_cycles - cycles.sum()) * scale,
+                               'fraction': 1 - cycles.sum() / loop_cycles if loop_cycles > 0 else 0.}
+        return breakdown
+
+    def print_profile(self):
+        """Prints the profile_breakdown() of the kernel"""
+        for name, b in self.profile_breakdown().items():
+            calls = '%12d calls' % b['calls'] if b['calls'] else ' ' * 18
+            print("%-30s %s %10.3e s (%5.1f%%)" % (name, calls, b['time'], 100 * b['fraction']))
 
     def merge(self, kernel, kclass):
         funcname = self.funcname + kernel.funcname
@@ -264,11 +384,18 @@ class BaseKernel(object):
             func_ast = FunctionDef(name=funcname, args=self.py_ast.args, body=self.py_ast.body + kernel.py_ast.body,
                                    decorator_list=[], lineno=1, col_offset=0)
         delete_cfiles = self.delete_cfiles and kernel.delete_cfiles
+        prefetch_distance = max(self.prefetch_distance, kernel.prefetch_distance)
+        profile = self.profile or kernel.profile
+        memory_budget = min([b for b in [self.memory_budget, kernel.memory_budget] if b is not None], default=None)
+        subkernels = None
+        if func_ast is not None:
+            subkernels = [sk for k in [self, kernel] for sk in (k.subkernels or [(k.funcname, len(k.py_ast.body))])]
         return kclass(self.fieldset, self.ptype, pyfunc=None,
                       funcname=funcname, funccode=self.funccode + kernel.funccode,
                       py_ast=func_ast, funcvars=self.funcvars + kernel.funcvars,
                       c_include=self._c_include + kernel.c_include,
-                      delete_cfiles=delete_cfiles)
+                      delete_cfiles=delete_cfiles, prefetch_distance=prefetch_distance,
+                      profile=profile, subkernels=subkernels, memory_budget=memory_budget)
 
     def __add__(self, kernel):
         if not isinstance(kernel, BaseKernel):
@@ -293,7 +420,9 @@ class BaseKernel(object):
         # Clean-up the in-memory dynamic linked libraries.
         # This is not really necessary, as these programs are not that large, but with the new random
         # naming scheme which is required on Windows OS'es to deal with updates to a Parcels' kernel.
-        if lib is not None:
+        if isinstance(lib, InMemoryLibrary):
+            lib.close()
+        elif lib is not None:
             try:
                 _ctypes.FreeLibrary(lib._handle) if platform == 'win32' else _ctypes.dlclose(lib._handle)
             except:
@@ -344,6 +473,71 @@ class BaseKernel(object):
                 if not g.lat.flags.c_contiguous:
                     g.lat = g.lat.copy()
 
+    def load_fieldset_python(self, pset, materialise=False):
+        """
+        Prepares the fields of pset's fieldset for the Scipy interpolators. Dask data is read through its chunks
+        (see Field.interpolation_data): as in load_fieldset_jit(), blocks requested by the last time chunk are
+        reloaded and blocks that were not touched are released. Other data, and all data if materialise (for
+        kernels that index Field.data directly), is converted to a numpy array
+        """
+        if pset.fieldset is None:
+            return
+        for f in pset.fieldset.get_fields():
+            if type(f) in [VectorField, NestedField, SummedField]:
+                continue
+            if isinstance(f.data, da.core.Array) and not materialise:
+                f.chunk_data()
+            else:
+                f.data = np.asarray(f.data)
+        for g in pset.fieldset.gridset.grids:
+            g.load_chunk = np.where(g.load_chunk == g.chunk_loading_requested,
+                                    g.chunk_loaded_touched, g.load_chunk)
+
+    @property
+    def boundary_policy(self):
+        """The (policy, box) arrays of FieldSet.set_boundary_policy(), or recovery kernels only if there is no FieldSet"""
+        if self._fieldset is None or not hasattr(self._fieldset, 'boundary_policy'):
+            return np.zeros(2, dtype=np.int32), np.array([-np.inf, np.inf] * 3, dtype=np.float64)
+        return self._fieldset.boundary_policy, self._fieldset.boundary_box
+
+    def boundary_policy_args(self):
+        """Pointers to the boundary policy arrays, for the particle_loop() of the JIT library"""
+        policy, box = self.boundary_policy
+        return [policy.ctypes.data_as(c_void_p), box.ctypes.data_as(c_void_p)]
+
+    def apply_boundary_policy(self, p, res, endtime):
+        """apply_boundary_policy() of parcels.h, for a Scipy particle that was reset to the start of its time step
+        after res. Returns Repeat if it was moved back into the domain, Delete, Success for a frozen particle,
+        or res if the error is left to the recovery kernels"""
+        if res not in [ErrorCode.ErrorOutOfBounds, ErrorCode.ErrorThroughSurface]:
+            return res
+        policies, box = self.boundary_policy
+        pos = np.array([p.lon, p.lat, p.depth], dtype=np.float64)
+        res = boundary.apply_boundary_policy(res, policies, box, pos)
+        if res == OperationCode.Repeat:
+            p.lon, p.lat, p.depth = pos
+        elif res == StateCode.Success:
+            p.time = endtime
+        return res
+
+    def boundary_resample_step(self, p, res):
+        """boundary_resample_step() of parcels.h, for a Scipy particle that was reset to the start of its time step"""
+        if res not in [ErrorCode.ErrorOutOfBounds, ErrorCode.ErrorThroughSurface]:
+            return False
+        policies, box = self.boundary_policy
+        return boundary.boundary_resample_step(res, policies, box, np.array([p.lon, p.lat, p.depth], dtype=np.float64))
+
+    def boundary_step_end(self, p):
+        """boundary_step_end() of parcels.h, for a Scipy particle that ended a successful time step"""
+        policies, box = self.boundary_policy
+        if not policies.any():  # all errors are left to the recovery kernels
+            return StateCode.Success
+        pos = np.array([p.lon, p.lat, p.depth], dtype=np.float64)
+        res = boundary.boundary_step_end(policies, box, pos)
+        if pos[0] != p.lon or pos[1] != p.lat or pos[2] != p.depth:
+            p.lon, p.lat, p.depth = pos
+        return res
+
     def evaluate_particle(self, p, endtime, sign_dt, dt, analytical=False):
         """
         Execute the kernel evaluation of for an individual particle.
@@ -375,6 +569,7 @@ class BaseKernel(object):
                 p.set_state(StateCode.Success)
             return p
 
+        resample = False
         while p.state in [StateCode.Evaluate, OperationCode.Repeat] or np.isclose(dt, 0):
             for var in variables:
                 p_var_back[var.name] = getattr(p, var.name)
@@ -382,7 +577,10 @@ class BaseKernel(object):
                 pdt_prekernels = sign_dt * dt_pos
                 p.dt = pdt_prekernels
                 state_prev = p.state
-                res = self._pyfunc(p, self._fieldset, p.time)
+                fieldset = self._fieldset
+                if resample:
+                    fieldset = boundary.ResampledFieldSet(fieldset, *self.boundary_policy)
+                res = self._pyfunc(p, fieldset, p.time)
                 if res is None:
                     res = StateCode.Success
 
@@ -406,8 +604,12 @@ class BaseKernel(object):
                 res = ErrorCode.Error
                 p.exception = e
 
+            if res == StateCode.Success:
+                res = self.boundary_step_end(p)
+
             # Handle particle time and time loop
             if res in [StateCode.Success, OperationCode.Delete]:
+                resample = False
                 # Update time and repeat
                 p.time += p.dt
                 if reset_dt and p.dt == pdt_prekernels:
@@ -432,11 +634,20 @@ class BaseKernel(object):
                 if np.isclose(dt, 0):
                     break
             else:
-                p.set_state(res)
                 # Try again without time update
                 for var in variables:
                     if var.name not in ['dt', 'state']:
                         setattr(p, var.name, p_var_back[var.name])
+                if not resample and self.boundary_resample_step(p, res):
+                    # repeat the step once, with the out-of-bounds field samples moved into the domain
+                    resample = True
+                    boundary_res = OperationCode.Repeat
+                else:
+                    resample = False
+                    boundary_res = self.apply_boundary_policy(p, res, endtime)
+                repeat = boundary_res == OperationCode.Repeat and res != OperationCode.Repeat
+                res = boundary_res
+                p.set_state(res)
                 if abs(endtime - p.time) < abs(p.dt):
                     dt_pos = abs(endtime - p.time)
                     reset_dt = True
@@ -447,7 +658,8 @@ class BaseKernel(object):
                 sign_end_part = np.sign(endtime - p.time)
                 if sign_end_part != sign_dt:
                     dt_pos = 0
-                break
+                if not repeat:
+                    break
         return p
 
     def execute_jit(self, pset, endtime, dt):
@@ -0,0 +1,157 @@
+"""Boundary policies of Scipy kernels, which call the C implementation in parcels.h (see FieldSet.set_boundary_policy)"""
+import threading
+import uuid
+from ctypes import c_int, c_void_p
+from os import path, remove
+
+import numpy as np
+import numpy.ctypeslib as npct
+
+from parcels.field import Field, VectorField, _isParticle
+from parcels.tools.global_statics import get_cache_dir, get_package_dir, cleanup_unload_lib
+from parcels.tools.loggers import logger
+from parcels.tools.statuscodes import ErrorCode, FieldOutOfBoundError, FieldOutOfBoundSurfaceError
+
+__all__ = ['apply_boundary_policy', 'boundary_resample_step', 'boundary_sample_position', 'boundary_step_end',
+           'ResampledFieldSet']
+
+
+class BoundaryC(object):
+    ccode = """#include "parcels.h"
+
+extern int pcls_apply_boundary_policy(int res, int *policies, double *box, double *pos){
+  return apply_boundary_policy(res, policies, box, pos);
+}
+
+extern int pcls_boundary_resample_step(int res, int *policies, double *box, double *pos){
+  return boundary_resample_step(res, policies, box, pos[0], pos[1], pos[2]);
+}
+
+extern int pcls_boundary_sample_position(int err, int *policies, double *box, double *pos){
+  return boundary_sample_position(err, policies, box, pos);
+}
+
+extern int pcls_boundary_step_end(int res, int *policies, double *box, double *pos){
+  return boundary_step_end(policies, box, pos);
+}
+"""
+    _lib = None
+    src_file = None
+    lib_file = None
+    log_file = None
+
+    def __del__(self):
+        if self._lib is not None:
+            cleanup_unload_lib(self._lib)
+            self._lib = None
+            [remove(s) for s in [self.src_file, self.lib_file, self.log_file] if path.isfile(s)]
+
+    def compile(self):
+        from parcels.compilation.codecompiler import GNUCompiler  # imported here, as the compilation module imports Field
+        basename = 'parcels_boundary_%s' % uuid.uuid4()
+        self.src_file = path.join(get_cache_dir(), "%s.c" % basename)
+        self.lib_file = path.join(get_cache_dir(), "lib%s.so" % basename)
+        self.log_file = path.join(get_cache_dir(), "%s.log" % basename)
+        with open(self.src_file, 'w+') as f:
+            f.write(self.ccode)
+        GNUCompiler(incdirs=[path.join(get_package_dir(), 'include')]).compile(self.src_file, self.lib_file, self.log_file)
+        logger.info("Compiled %s ==> %s" % ("ParcelsBoundary", self.lib_file))
+        self._lib = npct.load_library(self.lib_file, '.')
+        for name in ['pcls_apply_boundary_policy', 'pcls_boundary_resample_step', 'pcls_boundary_sample_position',
+                     'pcls_boundary_step_end']:
+            getattr(self._lib, name).argtypes = [c_int, c_void_p, c_void_p, c_void_p]
+            getattr(self._lib, name).restype = c_int
+
+    @property
+    def lib(self):
+        return self._lib
+
+
+_boundary_ccode = None
+_boundary_lock = threading.Lock()
+
+
+def _boundary_lib():
+    """Compiles the boundary policy library on first use"""
+    global _boundary_ccode
+    with _boundary_lock:
+        if _boundary_ccode is None:
+            ccode = BoundaryC()
+            ccode.compile()
+            _boundary_ccode = ccode
+        return _boundary_ccode.lib
+
+
+def _call(name, code, policies, box, pos):
+    policies = np.ascontiguousarray(policies, dtype=np.int32)
+    box = np.ascontiguousarray(box, dtype=np.float64)
+    return getattr(_boundary_lib(), name)(int(code), policies.ctypes.data, box.ctypes.data, pos.ctypes.data)
+
+
+def apply_boundary_policy(res, policies, box, pos):
+    """apply_boundary_policy() of parcels.h, for the float64 (lon, lat, depth) array pos, which is moved in place"""
+    return _call('pcls_apply_boundary_policy', res, policies, box, pos)
+
+
+def boundary_resample_step(res, policies, box, pos):
+    """boundary_resample_step() of parcels.h, for the (lon, lat, depth) array pos at the start of the time step"""
+    return bool(_call('pcls_boundary_resample_step', res, policies, box, pos))
+
+
+def boundary_sample_position(err, policies, box, pos):
+    """boundary_sample_position() of parcels.h, for the float64 (lon, lat, depth) array pos, which is moved in place"""
+    return bool(_call('pcls_boundary_sample_position', err, policies, box, pos))
+
+
+def boundary_step_end(policies, box, pos):
+    """boundary_step_end() of parcels.h, for the float64 (lon, lat, depth) array pos, which is moved in place"""
+    return _call('pcls_boundary_step_end', 0, policies, box, pos)
+
+
+class ResampledField(object):
+    """Field or VectorField whose samples that fail out of bounds are taken again at the position that
+    the boundary policies move them to (see boundary_sample_position() in parcels.h)"""
+
+    def __init__(self, field, policies, box):
+        self._field = field
+        self._policies = policies
+        self._box = box
+
+    def __getattr__(self, name):
+        return getattr(self._field, name)
+
+    def __getitem__(self, key):
+        if _isParticle(key):
+            return self.eval(key.time, key.depth, key.lat, key.lon, key)
+        else:
+            return self.eval(*key)
+
+    def eval(self, time, z, y, x, *args, **kwargs):
+        try:
+            return self._field.eval(time, z, y, x, *args, **kwargs)
+        except (FieldOutOfBoundError, FieldOutOfBoundSurfaceError) as e:
+            err = ErrorCode.ErrorThroughSurface if isinstance(e, FieldOutOfBoundSurfaceError) else ErrorCode.ErrorOutOfBounds
+            pos = np.array([x, y, z], dtype=np.float64)
+            if not boundary_sample_position(err, self._policies, self._box, pos):
+                raise
+            return self._field.eval(time, pos[2], pos[1], pos[0], *args, **kwargs)
+
+
+class ResampledFieldSet(object):
+    """FieldSet that is passed to a Scipy kernel when its time step is repeated with resampling (see
+    boundary_resample_step() in parcels.h): its Fields and VectorFields are ResampledFields for the boundary
+    policies and box. Samples of SummedFields and NestedFields are not moved"""
+
+    def __init__(self, fieldset, policies, box):
+        object.__setattr__(self, '_fieldset', fieldset)
+        object.__setattr__(self, '_policies', policies)
+        object.__setattr__(self, '_box', box)
+
+    def __getattr__(self, name):
+        attr = getattr(self._fieldset, name)
+        if isinstance(attr, (Field, VectorField)):
+            return ResampledField(attr, self._policies, self._box)
+        return attr
+
+    def __setattr__(self, name, value):
+        setattr(self._fieldset, name, value)
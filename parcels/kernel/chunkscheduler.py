@@ -0,0 +1,148 @@
+"""Out-of-core execution of JIT kernels over fields that are larger than the memory"""
+import dask.array as da
+import numpy as np
+
+from parcels.grid import RectilinearGrid
+from parcels.tools.statuscodes import StateCode, OperationCode
+from parcels.tools.tracing import tracer
+
+__all__ = ['ChunkScheduler']
+
+
+class ChunkScheduler(object):
+    """Scheduler that advances the particles of a SoA ParticleSet in groups, by the chunks (blocks) of the fields
+    that they are in, so that only a working set of chunks that fits in a memory budget is loaded at a time.
+
+    In each round, the particles that still have to be advanced are grouped by the blocks that they are in (found
+    from their coordinates on rectilinear grids and from their cached grid indices on curvilinear grids),
+    on each chunked grid of the kernel's fields. The working set is filled with the blocks of the
+    largest groups while it fits in half of the budget (the other half is headroom for the blocks that the particles
+    move into); all other blocks are released. The particles of the chosen groups are advanced to endtime while
+    the other particles are parked. A particle that moves into a block outside the working set (signalling REPEAT)
+    continues if that block still fits in the budget, and is otherwise deferred to a next round.
+
+    The budget is exceeded only by a single group whose blocks do not fit in it on their own, or
+    when a round could not advance any particle, in which case the next round loads all blocks it asks for.
+
+    :param kernel: KernelSOA to execute, in JIT mode
+    :param memory_budget: Maximum number of bytes of field data loaded at a time
+    """
+
+    def __init__(self, kernel, memory_budget):
+        self.kernel = kernel
+        self.memory_budget = memory_budget
+        self.rounds = 0
+
+    def chunked_grids(self):
+        """Dictionary of the grids of the kernel's fields that have more than one block of dask data, to one of
+        their fields (the fields on a grid share its chunking) and the number of bytes of each block of all
+        these fields together"""
+        grids = {}
+        for f in self.kernel.field_args.values():
+            if not isinstance(f.data, da.core.Array) or np.prod(f.data.numblocks[1:]) < 2:
+                continue
+            if not f.chunk_set:
+                f.chunk_setup()
+            if f.grid not in grids:
+                grids[f.grid] = [f, 0]
+            block_sizes = np.ones(1, dtype=np.int64)
+            for c in f.data.chunks[1:]:
+                block_sizes = np.multiply.outer(block_sizes, np.array(c, dtype=np.int64))
+            grids[f.grid][1] = grids[f.grid][1] + block_sizes.ravel() * f.grid.tdim * f.data.dtype.itemsize
+        return grids
+
+    @staticmethod
+    def cell_index(coords, x):
+        """Index of the cell of monotonic coordinates coords that contains x"""
+        if coords[-1] >= coords[0]:
+            i = np.searchsorted(coords, x, side='right') - 1
+        else:
+            i = len(coords) - 2 - (np.searchsorted(coords[::-1], x, side='left') - 1)
+        return np.clip(i, 0, max(len(coords) - 2, 0))
+
+    def particle_blocks(self, pset, f, indices):
+        """Block ids on the grid of field f of the cells of the particles at indices"""
+        dims = ['zi', 'yi', 'xi'][4 - len(f.data.chunks):]
+        block = []
+        for c, dim in zip(f.data.chunks[1:], dims):
+            coords = {'xi': f.grid.lon, 'yi': f.grid.lat, 'zi': f.grid.depth}[dim]
+            if isinstance(f.grid, RectilinearGrid) and coords.ndim == 1:
+                var = {'xi': 'lon', 'yi': 'lat', 'zi': 'depth'}[dim]
+                i = self.cell_index(coords, pset.collection.data[var][indices])
+            else:
+                i = pset.collection.data[dim][indices, f.igrid]
+            block.append(np.clip(np.searchsorted(np.cumsum(c), i, side='right'), 0, len(c) - 1))
+        return np.ravel_multi_index(block, f.data.numblocks[1:])
+
+    def working_set(self, pset, grids, todo):
+        """Chooses the blocks of the next round and the particles of todo that are advanced in it"""
+        ws = {g: set() for g in grids}
+        cost = 0
+        indices = np.flatnonzero(todo)
+        keys = np.stack([self.particle_blocks(pset, f, indices) for f, _ in grids.values()], axis=1)
+        unique_keys, inverse, counts = np.unique(keys, axis=0, return_inverse=True, return_counts=True)
+        chosen = np.zeros(len(unique_keys), dtype=bool)
+        for k in np.argsort(-counts, kind='stable'):
+            extra = sum(nbytes[b] for (g, (_, nbytes)), b in zip(grids.items(), unique_keys[k]) if b not in ws[g])
+            if cost + extra <= self.memory_budget / 2 or not chosen.any():
+                for g, b in zip(grids, unique_keys[k]):
+                    ws[g].add(b)
+                cost += extra
+                chosen[k] = True
+        group = np.zeros(len(todo), dtype=bool)
+        group[indices[chosen[inverse.ravel()]]] = True
+        return ws, cost, group
+
+    @staticmethod
+    def load_working_set(grids, ws):
+        """Requests the blocks of the working set that are not loaded, and releases all other blocks"""
+        for g in grids:
+            in_ws = np.zeros(len(g.load_chunk), dtype=bool)
+            in_ws[list(ws[g])] = True
+            g.load_chunk = np.where(in_ws & (g.load_chunk == g.chunk_not_loaded), g.chunk_loading_requested,
+                                    np.where(in_ws, g.load_chunk, g.chunk_not_loaded)).astype(g.load_chunk.dtype)
+
+    def execute(self, pset, endtime, dt):
+        """Advances all particles of pset that are to be evaluated to endtime, round by round"""
+        grids = self.chunked_grids()
+        if len(grids) == 0 or dt == 0:  # with dt == 0 the JIT loop also evaluates parked particles
+            return self.kernel.execute_jit(pset, endtime, dt)
+        state = pset.collection.state
+        todo = np.isin(state, [StateCode.Evaluate, OperationCode.Repeat])
+        force = False
+        while todo.any():
+            tic = tracer.now()
+            ws, cost, group = self.working_set(pset, grids, todo)
+            self.load_working_set(grids, ws)
+            parked = todo & ~group
+            state[parked] = StateCode.Success  # the JIT loop skips particles that are not to be evaluated
+            try:
+                state[group] = StateCode.Evaluate
+                time = pset.collection.time[group].copy()
+                deferred = np.zeros(len(todo), dtype=bool)
+                while True:
+                    self.kernel.execute_jit(pset, endtime, dt)
+                    repeat = state == OperationCode.Repeat
+                    if not repeat.any():
+                        break
+                    # admit the requested blocks that fit in the budget, and defer the particles if none does
+                    state[repeat] = StateCode.Evaluate
+                    admitted = False
+                    for g in grids:
+                        for b in np.flatnonzero(g.load_chunk == g.chunk_loading_requested):
+                            if force or cost + grids[g][1][b] <= self.memory_budget:
+                                cost += grids[g][1][b]
+                                ws[g].add(b)
+                                admitted = True
+                            else:
+                                g.load_chunk[b] = g.chunk_not_loaded
+                    if not admitted:
+                        deferred = repeat
+                        break
+            finally:  # parked particles are also restored if the kernel raises
+                state[parked] = StateCode.Evaluate
+            force = not ((group & ~deferred).any() or np.any(pset.collection.time[group] != time))
+            todo = parked | deferred
+            self.rounds += 1
+            tracer.add_span('out-of-core round', 'kernel', tic, kernel=self.kernel.name, particles=int(group.sum()),
+                            blocks=sum(len(ws[g]) for g in grids), bytes=int(cost))
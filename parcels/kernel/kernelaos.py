@@ -17,13 +17,11 @@ except:
 from parcels.kernel.basekernel import BaseKernel
 from parcels.compilation.codegenerator import ObjectKernelGenerator as KernelGenerator
 from parcels.compilation.codegenerator import ParticleObjectLoopGenerator
-from parcels.field import NestedField
-from parcels.field import SummedField
-from parcels.field import VectorField
 import parcels.rng as ParcelsRandom  # noqa
 from parcels.tools.statuscodes import StateCode, OperationCode, ErrorCode  # noqa
 from parcels.tools.statuscodes import recovery_map as recovery_base_map
 from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
 
 
 __all__ = ['KernelAOS']
@@ -35,6 +33,12 @@ class KernelAOS(BaseKernel):
     :arg fieldset: FieldSet object providing the field information
     :arg ptype: PType object for the kernel particle
     :param delete_cfiles: Boolean whether to delete the C-files after compilation in JIT mode (default is True)
+    :param prefetch_distance: Number of particles ahead for which the JIT loop prefetches the field cells
+           that those particles sampled last (default is 0, no prefetching)
+    :param profile: Boolean whether the JIT code counts the time and calls of each sub-kernel,
+           see profile_breakdown() (default is False)
+    :param memory_budget: Maximum number of bytes of chunked field data that the JIT loop keeps loaded; particles
+           are then advanced in groups by the chunks they are in, see ChunkScheduler (default is None, no budget)
 
     Note: A Kernel is either created from a compiled <function ...> object
     or the necessary information (funcname, funccode, funcvars) is provided.
@@ -43,8 +47,9 @@ class KernelAOS(BaseKernel):
     """
 
     def __init__(self, fieldset, ptype, pyfunc=None, funcname=None,
-                 funccode=None, py_ast=None, funcvars=None, c_include="", delete_cfiles=True):
-        super(KernelAOS, self).__init__(fieldset=fieldset, ptype=ptype, pyfunc=pyfunc, funcname=funcname, funccode=funccode, py_ast=py_ast, funcvars=funcvars, c_include=c_include, delete_cfiles=delete_cfiles)
+                 funccode=None, py_ast=None, funcvars=None, c_include="", delete_cfiles=True,
+                 prefetch_distance=0, profile=False, subkernels=None, memory_budget=None):
+        super(KernelAOS, self).__init__(fieldset=fieldset, ptype=ptype, pyfunc=pyfunc, funcname=funcname, funccode=funccode, py_ast=py_ast, funcvars=funcvars, c_include=c_include, delete_cfiles=delete_cfiles, prefetch_distance=prefetch_distance, profile=profile, subkernels=subkernels, memory_budget=memory_budget)
 
         # Derive meta information from pyfunc, if not given
         self.check_fieldsets_in_kernels(pyfunc)
@@ -91,7 +96,10 @@ class KernelAOS(BaseKernel):
         # Generate the kernel function and add the outer loop
         if self.ptype.uses_jit:
             kernelgen = KernelGenerator(self.fieldset, ptype)
-            kernel_ccode = kernelgen.generate(deepcopy(self.py_ast), self.funcvars)
+            py_ast = deepcopy(self.py_ast)
+            if self.profile:
+                py_ast = self.add_profile_sections(py_ast)
+            kernel_ccode = kernelgen.generate(py_ast, self.funcvars)
             self.field_args = kernelgen.field_args
             self.vector_field_args = kernelgen.vector_field_args
             for f in self.vector_field_args.values():
@@ -101,7 +109,12 @@ class KernelAOS(BaseKernel):
                         if sF_name != 'not_defined':
                             self.field_args[sF_name] = getattr(f, sF_component)
             self.const_args = kernelgen.const_args
-            loopgen = ParticleObjectLoopGenerator(self.fieldset, ptype)
+            if self.prefetch_distance > 0:
+                logger.warning_once("Prefetching is only available for SoA ParticleSets; using the default loop")
+            if self.memory_budget is not None:
+                logger.warning_once("Out-of-core execution with a memory_budget is only available for SoA ParticleSets; loading chunks on demand")
+            loopgen = ParticleObjectLoopGenerator(self.fieldset, ptype,
+                                                  profile_sections=len(self.subkernels) if self.profile else 0)
             if path.isfile(c_include):
                 with open(c_include, 'r') as f:
                     c_include_str = f.read()
@@ -143,13 +156,11 @@ class KernelAOS(BaseKernel):
             fargs += [c_double(f) for f in self.const_args.values()]
 
         pdata = pset.ctypes_struct
-        if len(fargs) > 0:
-            self._function(c_int(len(pset)), pdata, c_double(endtime), c_double(dt), *fargs)
-        else:
-            self._function(c_int(len(pset)), pdata, c_double(endtime), c_double(dt))
+        self.call_jit(c_int(len(pset)), pdata, c_double(endtime), c_double(dt), *self.boundary_policy_args(), *fargs)
 
     def execute_python(self, pset, endtime, dt):
         """Performs the core update loop via Python"""
+        tic = tracer.now()
         # sign of dt: { [0, 1]: forward simulation; -1: backward simulation }
         sign_dt = np.sign(dt)
 
@@ -160,14 +171,12 @@ class KernelAOS(BaseKernel):
                 logger.warning_once('dt is not used in AnalyticalAdvection, so is set to np.inf')
             dt = np.inf
 
-        if self.fieldset is not None:
-            for f in self.fieldset.get_fields():
-                if type(f) in [VectorField, NestedField, SummedField]:
-                    continue
-                f.data = np.array(f.data)
+        # AdvectionAnalytical indexes Field.data directly, so it needs all data in memory
+        self.load_fieldset_python(pset, materialise=analytical)
 
         for p in pset:
             self.evaluate_particle(p, endtime, sign_dt, dt, analytical=analytical)
+        tracer.add_span('execute_python', 'kernel', tic, kernel=self.name, particles=len(pset))
 
     def remove_deleted(self, pset, output_file, endtime):
         """Utility to remove all particles that signalled deletion"""
@@ -192,6 +201,7 @@ class KernelAOS(BaseKernel):
         recovery_map.update(recovery)
 
         if pset.fieldset is not None:
+            pset.fieldset.compress_cold_chunks()  # blocks that were not touched during the previous execution
             for g in pset.fieldset.gridset.grids:
                 if len(g.load_chunk) > g.chunk_not_loaded:  # not the case if a field in not called in the kernel
                     g.load_chunk = np.where(g.load_chunk == g.chunk_loaded_touched,
@@ -210,6 +220,7 @@ class KernelAOS(BaseKernel):
         error_particles = [p for p in pset if p.state not in [StateCode.Success, StateCode.Evaluate]]
 
         while len(error_particles) > 0:
+            tic = tracer.now()
             # Apply recovery kernel
             for p in error_particles:
                 if p.state == OperationCode.StopExecution:
@@ -230,6 +241,7 @@ class KernelAOS(BaseKernel):
 
             # Remove all particles that signalled deletion
             self.remove_deleted(pset, output_file=output_file, endtime=endtime)
+            tracer.add_span('recovery', 'kernel', tic, particles=len(error_particles))
 
             # Execute core loop again to continue interrupted particles
             if self.ptype.uses_jit:
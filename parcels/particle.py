@@ -7,7 +7,7 @@ from parcels.field import Field
 from parcels.tools.statuscodes import StateCode, OperationCode
 from parcels.tools.loggers import logger
 
-__all__ = ['ScipyParticle', 'JITParticle', 'Variable']
+__all__ = ['ScipyParticle', 'JITParticle', 'Variable', 'ColumnVariable']
 
 indicators_64bit = [np.float64, np.uint64, np.int64, c_void_p]
 
@@ -51,6 +51,38 @@ class Variable(object):
         return True if self.dtype in indicators_64bit else False
 
 
+class ColumnVariable(Variable):
+    """Particle Variable that holds a vertical profile per particle, e.g. for profiling floats,
+    virtual CTD casts or moorings, which is filled with Field.sample_column() in a kernel.
+    Within a (SoA) ParticleSet, the Variable is an array of shape [npart, size].
+
+    :param name: Variable name as used within kernels
+    :param depths: Depths at which the profile is sampled; or None (default) to sample the
+             Field at its own depth levels, in which case size should be its number of levels
+    :param size: Number of values in the profile (only needed if depths is None)
+    :param dtype: Data type (numpy.dtype) of the variable; only np.float32 is supported
+    :param initial: Initial value of the profile values
+
+    Note that a ColumnVariable is not written to the ParticleFile
+    """
+    def __init__(self, name, depths=None, size=None, dtype=np.float32, initial=0):
+        if dtype != np.float32:
+            raise NotImplementedError('ColumnVariable only supports dtype np.float32')
+        if depths is not None:
+            depths = np.array(depths, dtype=np.float64).ravel()
+            if size is not None and size != len(depths):
+                raise ValueError('size of ColumnVariable %s does not match the number of depths' % name)
+            size = len(depths)
+        if size is None or size < 1:
+            raise ValueError('ColumnVariable %s needs either depths or a size' % name)
+        super(ColumnVariable, self).__init__(name, dtype=dtype, initial=initial, to_write=False)
+        self.depths = depths
+        self.size = int(size)
+
+    def __repr__(self):
+        return "PColumnVar<%s|%s|%d>" % (self.name, self.dtype, self.size)
+
+
 class ParticleType(object):
     """Class encapsulating the type information for custom particles
 
@@ -87,7 +119,8 @@ class ParticleType(object):
 
     @property
     def _cache_key(self):
-        return "-".join(["%s:%s" % (v.name, v.dtype) for v in self.variables])
+        return "-".join(["%s:%s" % (v.name, v.dtype) + (":%d" % v.size if isinstance(v, ColumnVariable) else "")
+                         for v in self.variables])
 
     @property
     def dtype(self):
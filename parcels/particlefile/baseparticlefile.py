@@ -9,6 +9,8 @@ from abc import abstractmethod
 import netCDF4
 import numpy as np
 
+from parcels.tools.tracing import tracer
+
 try:
     from mpi4py import MPI
 except:
@@ -114,7 +116,8 @@ class BaseParticleFile(ABC):
 
         if MPI:
             mpi_rank = MPI.COMM_WORLD.Get_rank()
-            self.tempwritedir_base = MPI.COMM_WORLD.bcast(tmp_dir, root=0)
+            with tracer.span('MPI bcast', 'mpi'):
+                self.tempwritedir_base = MPI.COMM_WORLD.bcast(tmp_dir, root=0)
         else:
             self.tempwritedir_base = tmp_dir
             mpi_rank = 0
@@ -239,7 +242,8 @@ class BaseParticleFile(ABC):
     def close(self, delete_tempfiles=True):
         """Close the ParticleFile object by exporting and then deleting
         the temporary npy files"""
-        self.export()
+        with tracer.span('export output', 'io'):
+            self.export()
         mpi_rank = MPI.COMM_WORLD.Get_rank() if MPI else 0
         if mpi_rank == 0:
             if delete_tempfiles:
@@ -275,6 +279,19 @@ class BaseParticleFile(ABC):
                 np.save(f, data_dict_once)
             self.file_list_once.append(tmpfilename)
 
+    def memory_usage(self):
+        """Bytes of the output staged so far. The output is staged in temporary npy files, so nothing is held
+        in memory between writes; 'export_bytes' estimates the memory that export() needs to convert them,
+        as it reads one variable of all particles and output times at a time (as float64, plus a temporary copy)
+
+        :return: Dictionary with 'staged_files', 'staged_bytes_on_disk', 'staged_bytes_in_memory' and 'export_bytes'
+        """
+        files = (self.file_list or []) + (self.file_list_once or [])
+        return {'staged_files': len(files),
+                'staged_bytes_on_disk': sum(os.path.getsize(f) for f in files if os.path.isfile(f)),
+                'staged_bytes_in_memory': 0,
+                'export_bytes': 2 * 8 * (self.maxid_written + 1) * len(set(self.time_written))}
+
     @abstractmethod
     def get_pset_info_attributes(self):
         """
@@ -308,9 +325,10 @@ class BaseParticleFile(ABC):
         :param deleted_only: Flag to write only the deleted Particles
         """
 
-        data_dict, data_dict_once = pset.to_dict(self, time, deleted_only=deleted_only)
-        self.dump_dict_to_npy(data_dict, data_dict_once)
-        self.dump_psetinfo_to_npy()
+        with tracer.span('write output', 'io', time=float(time), deleted_only=deleted_only):
+            data_dict, data_dict_once = pset.to_dict(self, time, deleted_only=deleted_only)
+            self.dump_dict_to_npy(data_dict, data_dict_once)
+            self.dump_psetinfo_to_npy()
 
     @abstractmethod
     def read_from_npy(self, file_list, time_steps, var):
@@ -9,6 +9,7 @@ except:
     MPI = None
 
 from parcels.particlefile.baseparticlefile import BaseParticleFile
+from parcels.tools.tracing import tracer
 
 __all__ = ['ParticleFileAOS']
 
@@ -104,7 +105,8 @@ class ParticleFileAOS(BaseParticleFile):
         """
         if MPI:
             # The export can only start when all threads are done.
-            MPI.COMM_WORLD.Barrier()
+            with tracer.span('MPI Barrier', 'mpi'):
+                MPI.COMM_WORLD.Barrier()
             if MPI.COMM_WORLD.Get_rank() > 0:
                 return  # export only on threat 0
 
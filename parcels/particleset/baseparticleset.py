@@ -1,5 +1,6 @@
 import numpy as np
 from abc import ABC
+from concurrent.futures import ThreadPoolExecutor
 from abc import abstractmethod
 from datetime import datetime
 from datetime import timedelta as delta
@@ -11,13 +12,14 @@ import progressbar
 
 from parcels.tools.statuscodes import StateCode
 from parcels.tools.global_statics import get_package_dir
-from parcels.compilation.codecompiler import GNUCompiler
+from parcels.compilation.codecompiler import get_jit_compiler
 from parcels.field import NestedField
 from parcels.field import SummedField
 from parcels.application_kernels.advection import AdvectionRK4
 from parcels.kernel.basekernel import BaseKernel as Kernel
 from parcels.collection.collections import ParticleCollection
 from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
 
 
 class NDCluster(ABC):
@@ -36,6 +38,7 @@ class BaseParticleSet(NDCluster):
     repeatdepth = None
     repeatpclass = None
     repeatkwargs = None
+    _compile_future = None
 
     def __init__(self, fieldset=None, pclass=None, lon=None, lat=None, depth=None, time=None, repeatdt=None, lonlatdepth_dtype=None, pid_orig=None, **kwargs):
         self._collection = None
@@ -46,6 +49,7 @@ class BaseParticleSet(NDCluster):
         self.repeatpclass = None
         self.repeatkwargs = None
         self.kernel = None
+        self._compile_future = None
         self.fieldset = None
         self.time_origin = None
 
@@ -230,10 +234,14 @@ class BaseParticleSet(NDCluster):
         pass
 
     @abstractmethod
-    def Kernel(self, pyfunc, c_include="", delete_cfiles=True):
+    def Kernel(self, pyfunc, c_include="", delete_cfiles=True, prefetch_distance=0, profile=False,
+               memory_budget=None):
         """Wrapper method to convert a `pyfunc` into a :class:`parcels.kernel.Kernel` object
         based on `fieldset` and `ptype` of the ParticleSet
         :param delete_cfiles: Boolean whether to delete the C-files after compilation in JIT mode (default is True)
+        :param prefetch_distance: Number of particles ahead to prefetch field cells for in JIT mode (default is 0)
+        :param profile: Boolean whether to count the time and calls of each sub-kernel in JIT mode (default is False)
+        :param memory_budget: Maximum number of bytes of chunked field data to keep loaded in JIT mode (default is None)
         """
         pass
 
@@ -294,6 +302,61 @@ class BaseParticleSet(NDCluster):
                 min_rt = p.time
         return min_rt, max_rt
 
+    def _set_kernel(self, pyfunc):
+        """Generates and stores the Kernel for pyfunc if it is not the current kernel;
+        returns whether the kernel has to be (re)compiled"""
+        if self.kernel is not None and (self.kernel.pyfunc is pyfunc or self.kernel is pyfunc):
+            return False
+        self.kernel = pyfunc if isinstance(pyfunc, Kernel) else self.Kernel(pyfunc)
+        return self.collection.ptype.uses_jit
+
+    def _compile_kernel(self):
+        self.kernel.remove_lib()
+        cppargs = ['-DDOUBLE_COORD_VARIABLES'] if self.collection.lonlatdepth_dtype else None
+        self.kernel.compile(compiler=get_jit_compiler(cppargs=cppargs, incdirs=[path.join(get_package_dir(), 'include'), "."]))
+
+    def _wait_for_compile(self):
+        """Waits for a compilation started by prepare() and loads the compiled kernel.
+        If the compilation failed, the kernel is dropped, so that the next prepare() or execute() compiles it again"""
+        if self._compile_future is None:
+            return
+        kernel, future = self.kernel, self._compile_future
+        self._compile_future = None
+        try:
+            with tracer.span('wait for compile', 'kernel'):
+                future.result()
+            kernel.load_lib()
+        except:
+            self.kernel = None
+            raise
+
+    def prepare(self, pyfunc=AdvectionRK4, dt=1., wait=False):
+        """Prepares the execution of a kernel, so that the time to the first time step of execute()
+        is the maximum rather than the sum of the kernel compilation and the reading of the first field data:
+        in JIT mode, the kernel is compiled in a background thread while the first time steps of the fields
+        are loaded (with FieldSet.computeTimeChunk()) for the start time of execute() with this dt.
+        execute() with the same pyfunc then waits for the compilation to finish if needed.
+
+        :param pyfunc: Kernel function (or Kernel object) that will be passed to execute()
+        :param dt: Timestep interval that will be passed to execute(); only its sign is used, to determine the start time
+        :param wait: Boolean whether to wait for the compilation to finish before returning (default False)
+        :return: The prepared Kernel
+        """
+        self._wait_for_compile()
+        if self._set_kernel(pyfunc):
+            executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix='parcels-compile')
+            self._compile_future = executor.submit(self._compile_kernel)
+            executor.shutdown(wait=False)
+        if self.fieldset is not None:
+            if isinstance(dt, delta):
+                dt = dt.total_seconds()
+            mintime, maxtime = self.fieldset.gridset.dimrange('time_full')
+            min_rt, max_rt = self._impute_release_times(mintime if dt >= 0 else maxtime)
+            self.fieldset.computeTimeChunk(min_rt if dt >= 0 else max_rt, np.sign(dt))
+        if wait:
+            self._wait_for_compile()
+        return self.kernel
+
     def execute(self, pyfunc=AdvectionRK4, endtime=None, runtime=None, dt=1.,
                 moviedt=None, recovery=None, output_file=None, movie_background_field=None,
                 verbose_progress=None, postIterationCallbacks=None, callbackdt=None):
@@ -325,19 +388,17 @@ class BaseParticleSet(NDCluster):
         :param postIterationCallbacks: (Optional) Array of functions that are to be called after each iteration (post-process, non-Kernel)
         :param callbackdt: (Optional, in conjecture with 'postIterationCallbacks) timestep inverval to (latestly) interrupt the running kernel and invoke post-iteration callbacks from 'postIterationCallbacks'
         """
-        # check if pyfunc has changed since last compile. If so, recompile
-        if self.kernel is None or (self.kernel.pyfunc is not pyfunc and self.kernel is not pyfunc):
-            # Generate and store Kernel
-            if isinstance(pyfunc, Kernel):
-                self.kernel = pyfunc
-            else:
-                self.kernel = self.Kernel(pyfunc)
+        tic = tracer.now()
+        # finish a compilation started by prepare(), and check if pyfunc has changed since last compile. If so, recompile
+        self._wait_for_compile()
+        if self._set_kernel(pyfunc):
             # Prepare JIT kernel execution
-            if self.collection.ptype.uses_jit:
-                self.kernel.remove_lib()
-                cppargs = ['-DDOUBLE_COORD_VARIABLES'] if self.collection.lonlatdepth_dtype else None
-                self.kernel.compile(compiler=GNUCompiler(cppargs=cppargs, incdirs=[path.join(get_package_dir(), 'include'), "."]))
+            try:
+                self._compile_kernel()
                 self.kernel.load_lib()
+            except:
+                self.kernel = None
+                raise
 
         # Convert all time variables to seconds
         if isinstance(endtime, delta):
@@ -474,6 +535,7 @@ class BaseParticleSet(NDCluster):
             output_file.write(self, time)
         if verbose_progress:
             pbar.finish()
+        tracer.add_span('ParticleSet.execute', 'execute', tic, kernel=self.kernel.name, endtime=float(endtime))
 
     def show(self, with_particles=True, show_time=None, field=None, domain=None, projection=None,
              land=True, vmin=None, vmax=None, savefile=None, animation=False, **kwargs):
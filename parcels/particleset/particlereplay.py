@@ -0,0 +1,206 @@
+"""Sampling of fields along the trajectories stored in a ParticleFile, without advection"""
+import os
+
+import netCDF4
+import numpy as np
+
+from parcels.particle import JITParticle
+from parcels.particleset.particlesetsoa import ParticleSetSOA
+from parcels.tools.loggers import logger
+from parcels.tools.tracing import tracer
+
+__all__ = ['ParticleReplay']
+
+
+class ParticleReplay(object):
+    """Driver that replays the trajectories of a NetCDF ParticleFile to sample (new) fields along them,
+    calling only sampling kernels and no advection.
+
+    The stored positions are read in slabs of `chunksize` observations, and the output times are swept in the
+    direction of the run, so that the field data is loaded in time order (with FieldSet.computeTimeChunk()).
+    At each output time, the particles observed at that time are gathered from the loaded slabs into a
+    ParticleSet and the kernel is executed once on them (with dt=0). A slab is read when the sweep reaches its
+    first time and written to the companion file when the sweep has passed its last time.
+
+    The companion file has the same (traj, obs) layout as the ParticleFile, with its trajectory and time
+    variables and the Variables of pclass that are written to file (other than the positions), each with its
+    own dtype; observations of particles that were deleted by the kernel are NaN (or, for integer Variables,
+    the minimum of a signed and the maximum of an unsigned dtype).
+
+    :param fieldset: :mod:`parcels.fieldset.FieldSet` object to sample
+    :param pclass: :mod:`parcels.particle.JITParticle` or :mod:`parcels.particle.ScipyParticle`
+                 object with the Variables that the kernel samples into
+    :param filename: Name of the NetCDF ParticleFile with the trajectories
+    :param chunksize: Number of observations per slab of the trajectories that is read at a time
+    """
+
+    reserved_var_names = ['lon', 'lat', 'depth', 'time', 'id']
+
+    def __init__(self, fieldset, pclass=JITParticle, filename=None, chunksize=64):
+        self.fieldset = fieldset
+        self.pclass = pclass
+        self.filename = str(filename)
+        self.chunksize = chunksize
+        self.kernel = None
+
+        with netCDF4.Dataset(self.filename, 'r') as ds:
+            self.shape = ds.variables['time'].shape
+            units = getattr(ds.variables['time'], 'units', 'seconds')
+            origin = 'seconds' if fieldset.time_origin.calendar is None else 'seconds since ' + str(fieldset.time_origin)
+            if units != origin:
+                raise RuntimeError('Time units of %s (%s) do not match fieldset.time_origin (%s)' % (self.filename, units, origin))
+            self.lonlatdepth_dtype = np.float64 if ds.variables['lon'].dtype == np.float64 else np.float32
+            self.has_depth = 'z' in ds.variables
+
+            # time range and direction of each slab, and all output times of the file
+            self.slabs = []
+            self.direction = None
+            times = []
+            for o in range(0, self.shape[1], self.chunksize):
+                t = np.ma.filled(ds.variables['time'][:, o:o + self.chunksize], np.nan)
+                if np.all(np.isnan(t)):
+                    continue
+                self.slabs.append((o, min(o + self.chunksize, self.shape[1]), np.nanmin(t), np.nanmax(t)))
+                times.append(np.unique(t[~np.isnan(t)]))
+                dts = np.diff(t, axis=1)
+                if self.direction is None and np.any(~np.isnan(dts) & (dts != 0)):
+                    self.direction = -1 if np.nanmean(dts) < 0 else 1
+        self.direction = 1 if self.direction is None else self.direction
+        self.times = np.unique(np.concatenate(times)) if times else np.zeros(0)
+        if self.direction > 0:
+            self.slabs = sorted(self.slabs, key=lambda s: s[2])
+        else:
+            self.times = self.times[::-1]
+            self.slabs = sorted(self.slabs, key=lambda s: -s[3])
+
+        self.var_names = []
+        self.var_dtypes = {}
+        for v in pclass.getPType().variables:
+            if v.name in self.reserved_var_names:
+                continue
+            if v.to_write is True:
+                self.var_names.append(v.name)
+                self.var_dtypes[v.name] = np.dtype(v.dtype)
+            elif v.to_write == 'once':
+                logger.warning_once("Variable %s has to_write='once', and is not written in a replay" % v.name)
+
+    @staticmethod
+    def _fill_value(dtype):
+        """Value of the observations that are not sampled: NaN, or the extreme value of an integer dtype"""
+        if np.issubdtype(dtype, np.integer):
+            return np.iinfo(dtype).min if np.issubdtype(dtype, np.signedinteger) else np.iinfo(dtype).max
+        return np.nan
+
+    def _read_slab(self, ds, slab):
+        """Reads the positions and times of a slab, with the order of its records by time"""
+        o0, o1 = slab[:2]
+        data = {}
+        for var, name in [('lon', 'lon'), ('lat', 'lat'), ('depth', 'z'), ('time', 'time')]:
+            if var == 'depth' and not self.has_depth:
+                continue
+            data[var] = np.ma.filled(ds.variables[name][:, o0:o1], np.nan).ravel()
+        order = np.argsort(data['time'], kind='stable')
+        order = order[~np.isnan(data['time'][order])]
+        sampled = {v: np.full(len(data['time']), self._fill_value(self.var_dtypes[v]), dtype=self.var_dtypes[v])
+                   for v in self.var_names}
+        return {'slab': slab, 'data': data, 'order': order, 'sorted_time': data['time'][order], 'sampled': sampled}
+
+    def _write_slab(self, ds_in, ds_out, loaded):
+        o0, o1 = loaded['slab'][:2]
+        ds_out.variables['trajectory'][:, o0:o1] = ds_in.variables['trajectory'][:, o0:o1]
+        ds_out.variables['time'][:, o0:o1] = ds_in.variables['time'][:, o0:o1]
+        for v in self.var_names:
+            ds_out.variables[v][:, o0:o1] = loaded['sampled'][v].reshape((self.shape[0], o1 - o0))
+
+    def _create_output(self, ds_in, name):
+        extension = os.path.splitext(str(name))[1]
+        fname = name if extension in ['.nc', '.nc4'] else "%s.nc" % name
+        if os.path.exists(str(fname)):
+            os.remove(str(fname))
+        ds_out = netCDF4.Dataset(fname, "w", format="NETCDF4")
+        ds_out.createDimension("obs", self.shape[1])
+        ds_out.createDimension("traj", self.shape[0])
+        coords = ("traj", "obs")
+        for attr in ds_in.ncattrs():
+            setattr(ds_out, attr, getattr(ds_in, attr))
+        ds_out.parcels_replay_of = os.path.basename(self.filename)
+        for name in ['trajectory', 'time']:
+            var_in = ds_in.variables[name]
+            var = ds_out.createVariable(name, var_in.dtype, coords, fill_value=var_in._FillValue)
+            var.setncatts({a: var_in.getncattr(a) for a in var_in.ncattrs() if a != '_FillValue'})
+        for vname in self.var_names:
+            dtype = self.var_dtypes[vname]
+            var = ds_out.createVariable(vname, dtype, coords, fill_value=self._fill_value(dtype))
+            var.long_name = ""
+            var.standard_name = vname
+            var.units = "unknown"
+        return ds_out, fname
+
+    def _sample(self, pyfunc, loaded, t, recovery):
+        """Executes the kernel once on the particles of the loaded slabs that are observed at time t"""
+        slabs, records = [], []
+        for ld in loaded:
+            lo = np.searchsorted(ld['sorted_time'], t, side='left')
+            hi = np.searchsorted(ld['sorted_time'], t, side='right')
+            if hi > lo:
+                slabs.append(ld)
+                records.append(ld['order'][lo:hi])
+        if len(slabs) == 0:
+            return 0
+        coords = {var: np.concatenate([ld['data'][var][r] for ld, r in zip(slabs, records)])
+                  for var in ['lon', 'lat', 'depth'] if var in slabs[0]['data']}
+        pset = ParticleSetSOA(fieldset=self.fieldset, pclass=self.pclass, lon=coords['lon'], lat=coords['lat'],
+                              depth=coords.get('depth', None), time=t, lonlatdepth_dtype=self.lonlatdepth_dtype,
+                              partitions=False)
+        ids = pset.collection.data['id'].copy()
+        if self.kernel is None:
+            pset._set_kernel(pyfunc)
+            if pset.collection.ptype.uses_jit:
+                pset._compile_kernel()
+                pset.kernel.load_lib()
+            self.kernel = pset.kernel
+        pset._set_particle_vector('dt', 0.)
+        self.kernel.execute(pset, endtime=t, dt=0, recovery=recovery, execute_once=True)
+
+        # scatter the sampled values of the particles that were not deleted back to the records of the slabs
+        kept = np.searchsorted(ids, pset.collection.data['id'])
+        offsets = np.cumsum([0] + [len(r) for r in records])
+        for ld, r, o0, o1 in zip(slabs, records, offsets[:-1], offsets[1:]):
+            sel = (kept >= o0) & (kept < o1)
+            for v in self.var_names:
+                ld['sampled'][v][r[kept[sel] - o0]] = pset.collection.data[v][sel]
+        return len(pset)
+
+    def execute(self, pyfunc, output_name, recovery=None):
+        """Executes a sampling kernel along the trajectories and writes the sampled Variables to a companion file
+
+        :param pyfunc: Kernel function (or Kernel object) that samples the fields into Variables of pclass.
+               It should not move the particles, as their positions are not written back
+        :param output_name: Name of the companion NetCDF file to write the sampled Variables to
+        :param recovery: Dictionary with additional `:mod:parcels.tools.error` recovery kernels, as in
+               ParticleSet.execute()
+        :return: Name of the companion NetCDF file
+        """
+        tic = tracer.now()
+        direction = self.direction
+        with netCDF4.Dataset(self.filename, 'r') as ds_in:
+            ds_out, fname = self._create_output(ds_in, output_name)
+            loaded = []
+            pending = list(self.slabs)
+            nsampled = 0
+            for t in self.times:
+                # read the slabs that start at t, and write the slabs that end before t
+                while pending and (pending[0][2] <= t if direction > 0 else pending[0][3] >= t):
+                    loaded.append(self._read_slab(ds_in, pending.pop(0)))
+                for ld in [ld for ld in loaded if (ld['slab'][3] < t if direction > 0 else ld['slab'][2] > t)]:
+                    self._write_slab(ds_in, ds_out, ld)
+                    loaded.remove(ld)
+                tic_t = tracer.now()
+                self.fieldset.computeTimeChunk(t, direction)
+                nsampled += self._sample(pyfunc, loaded, t, recovery)
+                tracer.add_span('replay time', 'execute', tic_t, time=float(t), slabs=len(loaded))
+            for ld in loaded + [self._read_slab(ds_in, s) for s in pending]:
+                self._write_slab(ds_in, ds_out, ld)
+            ds_out.close()
+        tracer.add_span('ParticleReplay.execute', 'execute', tic, records=nsampled)
+        return fname
@@ -676,13 +676,18 @@ def search_kernel(particle, fieldset, time):
 
         return density
 
-    def Kernel(self, pyfunc, c_include="", delete_cfiles=True):
+    def Kernel(self, pyfunc, c_include="", delete_cfiles=True, prefetch_distance=0, profile=False,
+               memory_budget=None):
         """Wrapper method to convert a `pyfunc` into a :class:`parcels.kernel.Kernel` object
         based on `fieldset` and `ptype` of the ParticleSet
 
         :param delete_cfiles: Boolean whether to delete the C-files after compilation in JIT mode (default is True)
+        :param prefetch_distance: Not supported for AoS ParticleSets (default is 0)
+        :param profile: Boolean whether to count the time and calls of each sub-kernel in JIT mode,
+               see Kernel.profile_breakdown() (default is False)
+        :param memory_budget: Not supported for AoS ParticleSets (default is None)
         """
-        return KernelAOS(self.fieldset, self.collection.ptype, pyfunc=pyfunc, c_include=c_include, delete_cfiles=delete_cfiles)
+        return KernelAOS(self.fieldset, self.collection.ptype, pyfunc=pyfunc, c_include=c_include, delete_cfiles=delete_cfiles, prefetch_distance=prefetch_distance, profile=profile, memory_budget=memory_budget)
 
     def ParticleFile(self, *args, **kwargs):
         """Wrapper method to initialise a :class:`parcels.particlefile.ParticleFile`
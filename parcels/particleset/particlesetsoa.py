@@ -539,14 +539,23 @@ def search_kernel(particle, fieldset, time):
 
         return density
 
-    def Kernel(self, pyfunc, c_include="", delete_cfiles=True):
+    def Kernel(self, pyfunc, c_include="", delete_cfiles=True, prefetch_distance=0, profile=False,
+               memory_budget=None):
         """Wrapper method to convert a `pyfunc` into a :class:`parcels.kernel.Kernel` object
         based on `fieldset` and `ptype` of the ParticleSet
 
         :param delete_cfiles: Boolean whether to delete the C-files after compilation in JIT mode (default is True)
+        :param prefetch_distance: Number of particles ahead for which the JIT loop prefetches the field cells
+               that those particles sampled last, hiding the latency of gathers on large fields (default is 0)
+        :param profile: Boolean whether to count the time and calls of each sub-kernel in JIT mode,
+               see Kernel.profile_breakdown() (default is False)
+        :param memory_budget: Maximum number of bytes of chunked field data to keep loaded in JIT mode. Particles are
+               then advanced in groups by the field chunks they are in, so that fields larger than the memory can be
+               used without thrashing, see ChunkScheduler (default is None, chunks are loaded on demand)
         """
         return Kernel(self.fieldset, self.collection.ptype, pyfunc=pyfunc, c_include=c_include,
-                      delete_cfiles=delete_cfiles)
+                      delete_cfiles=delete_cfiles, prefetch_distance=prefetch_distance,
+                      profile=profile, memory_budget=memory_budget)
 
     def ParticleFile(self, *args, **kwargs):
         """Wrapper method to initialise a :class:`parcels.particlefile.ParticleFile`
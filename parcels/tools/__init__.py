@@ -1,6 +1,11 @@
+from .allocation import *  # noqa
 from .converters import *  # noqa
 from .global_statics import *  # noqa
 from .statuscodes import *  # noqa
 from .interpolation_utils import *  # noqa
+from .landproximity import *  # noqa
 from .loggers import *  # noqa
 from .timer import *  # noqa
+from .tracing import *  # noqa
+from .memory import *  # noqa
+from .sharedmemory import *  # noqa
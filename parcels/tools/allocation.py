@@ -0,0 +1,246 @@
+"""Placement-aware allocation of field chunks and particle columns"""
+import ctypes
+import ctypes.util
+import mmap
+import os
+from glob import glob
+
+import numpy as np
+
+from parcels.tools.loggers import logger
+try:
+    from mpi4py import MPI
+except:
+    MPI = None
+
+__all__ = ['set_numa_policy', 'get_numa_policy', 'set_hugepage_policy', 'get_hugepage_policy',
+           'numa_nodes', 'pin_to_numa_node', 'empty_placed', 'array_placed', 'concatenate_placed', 'delete_placed']
+
+numa_policies = [None, 'firsttouch', 'interleave', 'local']
+hugepage_policies = [None, 'thp', 'hugetlb']
+hugepage_size = 2 * 1024 * 1024
+hugepage_min_bytes = hugepage_size  # smaller buffers would waste most of a huge page
+
+MADV_HUGEPAGE = getattr(mmap, 'MADV_HUGEPAGE', 14)
+MAP_HUGETLB = getattr(mmap, 'MAP_HUGETLB', 0x40000)
+
+_allocation_settings = {'numa': None, 'node': None, 'hugepages': None}
+_libnuma = None
+_libc = None
+
+
+def _load_libnuma():
+    global _libnuma
+    if _libnuma is None:
+        _libnuma = False
+        libname = ctypes.util.find_library('numa')
+        if libname is not None:
+            try:
+                lib = ctypes.CDLL(libname)
+                if lib.numa_available() >= 0:
+                    lib.numa_interleave_memory.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p]
+                    lib.numa_tonode_memory.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_int]
+                    _libnuma = lib
+            except OSError:
+                pass
+    return _libnuma
+
+
+def numa_nodes():
+    """Returns a dictionary {node: [cpus]} of the NUMA nodes of this machine, as listed in
+    /sys/devices/system/node. Returns a single node holding all cpus if that information is not available"""
+    nodes = {}
+    for nodedir in sorted(glob('/sys/devices/system/node/node[0-9]*')):
+        try:
+            with open(os.path.join(nodedir, 'cpulist')) as f:
+                cpulist = f.read().strip()
+        except OSError:
+            continue
+        cpus = []
+        for part in cpulist.split(','):
+            if '-' in part:
+                lo, hi = part.split('-')
+                cpus += list(range(int(lo), int(hi)+1))
+            elif part:
+                cpus.append(int(part))
+        if len(cpus) > 0:
+            nodes[int(os.path.basename(nodedir)[4:])] = cpus
+    if len(nodes) == 0:
+        nodes[0] = list(range(os.cpu_count() or 1))
+    return nodes
+
+
+def pin_to_numa_node(node=None):
+    """Pins the calling process to the cpus of one NUMA node, so that first-touch placement
+    of field chunks and particle columns happens on the socket that later processes them.
+
+    :param node: NUMA node to pin to. If None, MPI ranks are distributed round-robin over the nodes
+    :returns: the node that the process was pinned to, or None if pinning is not supported"""
+    if not hasattr(os, 'sched_setaffinity'):
+        logger.warning_once('Pinning to a NUMA node is not supported on this platform')
+        return None
+    nodes = numa_nodes()
+    if node is None:
+        rank = MPI.COMM_WORLD.Get_rank() if MPI else 0
+        node = sorted(nodes.keys())[rank % len(nodes)]
+    if node not in nodes:
+        raise ValueError('NUMA node %s does not exist; available nodes are %s' % (node, sorted(nodes.keys())))
+    os.sched_setaffinity(0, nodes[node])
+    _allocation_settings['node'] = node
+    return node
+
+
+def set_numa_policy(policy=None, pin=False, node=None):
+    """Sets the NUMA placement policy for field chunks (Field.data_chunks) and SoA particle columns
+
+    :param policy: None (numpy default), 'firsttouch' (pages are untouched until the data is copied in
+           by the process that uses them), 'interleave' (pages are spread round-robin over all nodes)
+           or 'local' (pages are bound to the node the process is pinned to). 'local' only binds pages
+           once the process is pinned, through pin=True or :func:`pin_to_numa_node`; until then it behaves as 'firsttouch'
+    :param pin: Boolean whether to also pin the process to a NUMA node (see :func:`pin_to_numa_node`)
+    :param node: NUMA node to pin to (only used if pin=True)
+    """
+    if policy not in numa_policies:
+        raise ValueError('NUMA policy should be one of %s' % numa_policies)
+    if policy in ['interleave', 'local'] and not _load_libnuma():
+        logger.warning_once("libnuma is not available: NUMA policy '%s' falls back to 'firsttouch'" % policy)
+        policy = 'firsttouch'
+    _allocation_settings['numa'] = policy
+    if pin:
+        pin_to_numa_node(node)
+    elif policy == 'local' and _allocation_settings['node'] is None:
+        logger.warning_once("NUMA policy 'local' has no effect until the process is pinned to a node "
+                            "(use pin=True or pin_to_numa_node()); pages are placed on first touch")
+
+
+def get_numa_policy():
+    return _allocation_settings['numa']
+
+
+def set_hugepage_policy(policy=None):
+    """Sets whether field chunks (Field.data_chunks) and SoA particle columns are backed by 2 MB huge pages,
+    which reduces dTLB misses when sampling jumps between distant rows of large chunks
+
+    :param policy: None (default pages), 'thp' (transparent huge pages, requested with madvise) or
+           'hugetlb' (MAP_HUGETLB from the pre-reserved pool; falls back to 'thp' if the pool is exhausted)
+    """
+    if policy not in hugepage_policies:
+        raise ValueError('Huge page policy should be one of %s' % hugepage_policies)
+    if policy is not None and not hasattr(mmap, 'MAP_ANONYMOUS'):
+        logger.warning_once('Huge pages are not supported on this platform')
+        policy = None
+    _allocation_settings['hugepages'] = policy
+
+
+def get_hugepage_policy():
+    return _allocation_settings['hugepages']
+
+
+def _madvise_hugepage(buf, addr, nbytes):
+    global _libc
+    if hasattr(buf, 'madvise'):
+        try:
+            buf.madvise(MADV_HUGEPAGE)
+            return True
+        except OSError:
+            return False
+    if _libc is None:
+        _libc = ctypes.CDLL(ctypes.util.find_library('c'), use_errno=True)
+        _libc.madvise.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_int]
+    # madvise requires a page-aligned start address
+    pagesize = mmap.PAGESIZE
+    start = addr - addr % pagesize
+    return _libc.madvise(start, nbytes + addr - start, MADV_HUGEPAGE) == 0
+
+
+def _mmap_empty(nbytes):
+    """Anonymous, page-aligned mapping. The kernel only places its pages on a node when they are first written.
+    Returns the mapping and the byte offset at which the array should start"""
+    flags = mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS
+    hugepages = _allocation_settings['hugepages'] if nbytes >= hugepage_min_bytes else None
+    if hugepages == 'hugetlb':
+        try:
+            return mmap.mmap(-1, -(-nbytes // hugepage_size) * hugepage_size, flags=flags | MAP_HUGETLB), 0
+        except OSError:
+            logger.warning_once('Could not allocate from the huge page pool (see /proc/sys/vm/nr_hugepages); '
+                                'falling back to transparent huge pages')
+    if hugepages is None:
+        return mmap.mmap(-1, max(nbytes, 1), flags=flags), 0
+    # over-allocate so that the array can start on a huge page boundary
+    buf = mmap.mmap(-1, nbytes + hugepage_size, flags=flags)
+    addr = np.frombuffer(buf, dtype=np.uint8, count=1).ctypes.data
+    offset = -addr % hugepage_size
+    if not _madvise_hugepage(buf, addr, nbytes + hugepage_size):
+        logger.warning_once('Transparent huge pages are not available (see /sys/kernel/mm/transparent_hugepage/enabled)')
+    return buf, offset
+
+
+def empty_placed(shape, dtype):
+    """Returns an uninitialised array, allocated according to the current NUMA and huge page policies.
+    The array is not touched here, so the caller should fill it from the thread that will use it."""
+    policy = _allocation_settings['numa']
+    dtype = np.dtype(dtype)
+    if (policy is None and _allocation_settings['hugepages'] is None) or dtype.hasobject \
+            or not hasattr(mmap, 'MAP_ANONYMOUS'):
+        return np.empty(shape, dtype=dtype)
+    nbytes = int(np.prod(shape)) * dtype.itemsize
+    buf, offset = _mmap_empty(nbytes)
+    arr = np.frombuffer(buf, dtype=dtype, count=int(np.prod(shape)), offset=offset).reshape(shape)
+    if nbytes > 0 and policy in ['interleave', 'local']:
+        lib = _load_libnuma()
+        if policy == 'interleave':
+            lib.numa_interleave_memory(arr.ctypes.data, nbytes, ctypes.c_void_p.in_dll(lib, 'numa_all_nodes_ptr'))
+        elif _allocation_settings['node'] is not None:
+            lib.numa_tonode_memory(arr.ctypes.data, nbytes, _allocation_settings['node'])
+    return arr
+
+
+def is_placed(arr):
+    """Returns whether arr is a C-contiguous array allocated according to the current NUMA and huge page policies"""
+    if not isinstance(arr, np.ndarray) or not arr.flags.c_contiguous:
+        return False
+    if _allocation_settings['numa'] is None and _allocation_settings['hugepages'] is None:
+        return True
+    base = arr
+    while isinstance(base, np.ndarray) and base.base is not None:
+        base = base.base
+    if isinstance(base, memoryview):
+        base = base.obj
+    return isinstance(base, mmap.mmap)
+
+
+def array_placed(data, dtype=None, copy=True):
+    """Copies data (numpy or dask array) into a C-contiguous array allocated according to the current
+    NUMA and huge page policies. Equivalent to np.array(data, order='C') if no policy is set
+
+    :param copy: If False, data is returned as is if it already is such an array (see :func:`is_placed`),
+           so that the result may alias data"""
+    if not copy and is_placed(data) and (dtype is None or data.dtype == dtype):
+        return data
+    if _allocation_settings['numa'] is None and _allocation_settings['hugepages'] is None:
+        return np.array(data, dtype=dtype, order='C')
+    data = np.asarray(data, dtype=dtype)
+    arr = empty_placed(data.shape, data.dtype)
+    arr[...] = data
+    return arr
+
+
+def concatenate_placed(arrays):
+    """Concatenates arrays along the first axis into a new array allocated according to the current
+    NUMA and huge page policies. Equivalent to np.concatenate(arrays) if no policy is set"""
+    if _allocation_settings['numa'] is None and _allocation_settings['hugepages'] is None:
+        return np.concatenate(arrays)
+    dtype = np.result_type(*arrays)
+    out = empty_placed((sum(a.shape[0] for a in arrays),) + arrays[0].shape[1:], dtype)
+    return np.concatenate(arrays, out=out)
+
+
+def delete_placed(arr, indices):
+    """Removes the entries at indices along the first axis, returning a new array allocated according to
+    the current NUMA and huge page policies. Equivalent to np.delete(arr, indices, axis=0) if no policy is set"""
+    if _allocation_settings['numa'] is None and _allocation_settings['hugepages'] is None:
+        return np.delete(arr, indices, axis=0)
+    keep = np.ones(arr.shape[0], dtype=bool)
+    keep[indices] = False
+    out = empty_placed((int(np.count_nonzero(keep)),) + arr.shape[1:], arr.dtype)
+    return np.compress(keep, arr, axis=0, out=out)
@@ -0,0 +1,79 @@
+"""In-memory compression of field blocks that are loaded but not in use"""
+import zlib
+
+import numpy as np
+try:
+    from numcodecs import blosc, Blosc
+except ImportError:
+    Blosc = None
+
+from parcels.tools.allocation import empty_placed
+from parcels.tools.ingest import ingest
+from parcels.tools.loggers import logger
+
+__all__ = ['ChunkCompressor']
+
+
+class CompressedBlock(object):
+    """Compressed copy of a block of field data, with the shape and dtype to restore it"""
+    __slots__ = ['payload', 'shape', 'dtype', 'nbytes']
+
+    def __init__(self, payload, shape, dtype):
+        self.payload = payload
+        self.shape = shape
+        self.dtype = dtype
+        self.nbytes = len(payload)
+
+
+class ChunkCompressor(object):
+    """Codec for the blocks of a chunked Field that are kept compressed in memory while they are cold
+    (see FieldSet.set_chunk_compression()).
+
+    Blocks are byte-shuffled and compressed with a Blosc compressor (from numcodecs) or, if numcodecs is not
+    installed or codec is 'zlib', with zlib. Compression is lossless, unless keepbits is given: the float32
+    mantissa is then first rounded to keepbits bits (as in the ingest of field data), which bounds the relative
+    error of each value to 2**-(keepbits+1) and makes the block compress much better.
+
+    :param codec: Name of the compressor: 'lz4' (default), 'lz4hc', 'zstd', 'blosclz' or 'zlib'
+    :param keepbits: Number of mantissa bits (0 to 23) that are kept (default None: lossless)
+    :param clevel: Compression level (1 to 9)
+    """
+
+    def __init__(self, codec='lz4', keepbits=None, clevel=5):
+        if keepbits is not None and not 0 <= keepbits <= 23:
+            raise ValueError('keepbits should be between 0 and 23')
+        self.keepbits = keepbits
+        self.clevel = clevel
+        if Blosc is not None and codec in blosc.list_compressors():
+            self.codec = Blosc(cname=codec, clevel=clevel, shuffle=Blosc.SHUFFLE)
+        elif codec in ['zlib', 'lz4', 'lz4hc', 'zstd', 'blosclz']:
+            self.codec = None  # zlib, also as the fallback for the Blosc compressors
+            if codec != 'zlib':
+                logger.warning_once("Chunk compression codec '%s' is not available (%s), falling back to zlib"
+                                    % (codec, 'numcodecs is not installed' if Blosc is None else 'not in numcodecs.blosc'))
+        else:
+            raise ValueError("Unknown chunk compression codec '%s'" % codec)
+        self.name = codec if self.codec is not None else 'zlib'
+
+    def compress(self, block):
+        """Compressed copy of a numpy block"""
+        block = np.asarray(block)
+        if self.keepbits is not None and block.dtype == np.float32:
+            block = ingest(block, keepbits=self.keepbits)
+        block = np.ascontiguousarray(block)
+        if self.codec is not None:
+            payload = self.codec.encode(block)
+        else:
+            shuffled = block.view(np.uint8).reshape(-1, block.itemsize).T.copy()
+            payload = zlib.compress(shuffled, self.clevel)
+        return CompressedBlock(bytes(payload), block.shape, block.dtype)
+
+    def decompress(self, compressed):
+        """Restores a compressed block into a new C-contiguous array (allocated with empty_placed())"""
+        out = empty_placed(compressed.shape, compressed.dtype)
+        if self.codec is not None:
+            self.codec.decode(compressed.payload, out=out)
+        else:
+            shuffled = np.frombuffer(zlib.decompress(compressed.payload), dtype=np.uint8)
+            out.view(np.uint8).reshape(-1, out.itemsize)[...] = shuffled.reshape(out.itemsize, -1).T
+        return out
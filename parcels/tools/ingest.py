@@ -0,0 +1,174 @@
+"""Fused post-processing of freshly loaded field data"""
+import threading
+import uuid
+from concurrent.futures import ThreadPoolExecutor
+from ctypes import c_float, c_int, c_int64, c_void_p
+from os import cpu_count, path, remove
+
+import dask.array as da
+import numpy as np
+import numpy.ctypeslib as npct
+
+from parcels.tools.allocation import empty_placed
+from parcels.tools.global_statics import get_cache_dir, cleanup_unload_lib
+from parcels.tools.loggers import logger
+
+__all__ = ['ingest']
+
+ingest_min_size = 2**16  # smaller arrays are processed with numpy, which avoids compiling the library
+ingest_size_per_thread = 2**20  # elements per thread for large numpy arrays
+
+
+class IngestC(object):
+    ccode = """#include <stdint.h>
+
+/* Single pass over a 4D strided float32 view (strides in elements, possibly negative), writing the
+ * C-contiguous rows [row_start, row_stop) of dst. A row is one x-line; dst may alias src if src is C-contiguous */
+extern void pcls_ingest(float *src, float *dst, int64_t *shape, int64_t *strides, int64_t row_start, int64_t row_stop,
+                        float scale, int clamp_min, float vmin, int clamp_max, float vmax, int keepbits)
+{
+  uint32_t mask = 0xffffffff, half = 0;
+  if (keepbits >= 0 && keepbits < 23){
+    mask <<= 23 - keepbits;
+    half = 1u << (22 - keepbits);
+  }
+  int64_t row, i;
+  for (row = row_start; row < row_stop; ++row){
+    int64_t i2 = row % shape[2];
+    int64_t i1 = (row / shape[2]) % shape[1];
+    int64_t i0 = row / (shape[2] * shape[1]);
+    float *s = src + i0*strides[0] + i1*strides[1] + i2*strides[2];
+    float *d = dst + row*shape[3];
+    for (i = 0; i < shape[3]; ++i){
+      float v = s[i*strides[3]];
+      if (v != v) v = 0;
+      v *= scale;
+      if (clamp_min && v < vmin) v = 0;
+      if (clamp_max && v > vmax) v = 0;
+      if (half){
+        union {float f; uint32_t u;} bits;
+        bits.f = v;
+        if ((bits.u & 0x7f800000) != 0x7f800000){
+          bits.u = (bits.u + half) & mask;
+          v = bits.f;
+        }
+      }
+      d[i] = v;
+    }
+  }
+}
+"""
+    _lib = None
+    src_file = None
+    lib_file = None
+    log_file = None
+
+    def __del__(self):
+        if self._lib is not None:
+            cleanup_unload_lib(self._lib)
+            self._lib = None
+            [remove(s) for s in [self.src_file, self.lib_file, self.log_file] if path.isfile(s)]
+
+    def compile(self):
+        from parcels.compilation.codecompiler import GNUCompiler  # imported here, as the compilation module imports Field
+        basename = 'parcels_ingest_%s' % uuid.uuid4()
+        self.src_file = path.join(get_cache_dir(), "%s.c" % basename)
+        self.lib_file = path.join(get_cache_dir(), "lib%s.so" % basename)
+        self.log_file = path.join(get_cache_dir(), "%s.log" % basename)
+        with open(self.src_file, 'w+') as f:
+            f.write(self.ccode)
+        GNUCompiler().compile(self.src_file, self.lib_file, self.log_file)
+        logger.info("Compiled %s ==> %s" % ("ParcelsIngest", self.lib_file))
+        self._lib = npct.load_library(self.lib_file, '.')
+        self._lib.pcls_ingest.argtypes = [c_void_p, c_void_p, c_void_p, c_void_p, c_int64, c_int64,
+                                          c_float, c_int, c_float, c_int, c_float, c_int]
+        self._lib.pcls_ingest.restype = None
+
+    @property
+    def lib(self):
+        return self._lib
+
+
+_ingest_ccode = None
+_ingest_lock = threading.Lock()
+_ingest_pool = None
+
+
+def _ingest_lib():
+    """Compiles the ingest library on first use. Returns None if that is not possible"""
+    global _ingest_ccode
+    with _ingest_lock:
+        if _ingest_ccode is None:
+            _ingest_ccode = IngestC()
+            try:
+                _ingest_ccode.compile()
+            except Exception as e:
+                logger.warning_once('Could not compile the ingest library (%s); field data is post-processed with numpy' % e)
+        return _ingest_ccode.lib
+
+
+def _ingest_threads():
+    """Thread pool for large numpy arrays, created on first use"""
+    global _ingest_pool
+    with _ingest_lock:
+        if _ingest_pool is None:
+            _ingest_pool = ThreadPoolExecutor(max_workers=cpu_count())
+        return _ingest_pool
+
+
+def _ingest_numpy(data, out, scaling_factor, vmin, vmax, keepbits):
+    if out is not data:
+        out[...] = data
+    out[np.isnan(out)] = 0
+    if scaling_factor:
+        out *= scaling_factor
+    if vmin is not None:
+        out[out < vmin] = 0
+    if vmax is not None:
+        out[out > vmax] = 0
+    if keepbits is not None and keepbits < 23:
+        bits = out.view(np.uint32)
+        finite = (bits & 0x7f800000) != 0x7f800000
+        rounded = (bits + np.uint32(1 << (22 - keepbits))) & np.uint32((0xffffffff << (23 - keepbits)) & 0xffffffff)
+        bits[finite] = rounded[finite]
+    return out
+
+
+def ingest(data, scaling_factor=None, vmin=None, vmax=None, keepbits=None, inplace=False):
+    """Post-processes freshly loaded field data in a single pass: NaNs are set to zero, the data is multiplied
+    by scaling_factor, values below vmin or above vmax are set to zero and, if keepbits is given, the float32
+    mantissa is rounded to keepbits bits (so that the data compresses better). The result is C-contiguous float32.
+
+    Dask arrays are processed lazily, one call per chunk, so that dask runs the chunks in parallel when they are
+    computed. Large numpy arrays are split over threads.
+
+    :param inplace: Boolean whether to overwrite data, if it is a C-contiguous float32 numpy array.
+           The result is then data itself, so it still aliases the caller's array.
+           Otherwise, the result is allocated with empty_placed()
+    """
+    if isinstance(data, da.core.Array):
+        return data.map_blocks(ingest, scaling_factor=scaling_factor, vmin=vmin, vmax=vmax, keepbits=keepbits,
+                               dtype=np.float32)
+    data = np.asarray(data)
+    if inplace and data.dtype == np.float32 and data.flags.c_contiguous and data.flags.writeable:
+        out = data
+    else:
+        out = empty_placed(data.shape, np.float32)
+    lib = _ingest_lib() if data.size >= ingest_min_size and data.ndim <= 4 and data.dtype == np.float32 else None
+    if lib is None or any(s % data.itemsize for s in data.strides):
+        return _ingest_numpy(data, out, scaling_factor, vmin, vmax, keepbits)
+
+    shape = np.array((1,) * (4 - data.ndim) + data.shape, dtype=np.int64)
+    strides = np.array((0,) * (4 - data.ndim) + tuple(s // data.itemsize for s in data.strides), dtype=np.int64)
+    args = (data.ctypes.data, out.ctypes.data, shape.ctypes.data, strides.ctypes.data)
+    params = (1. if not scaling_factor else scaling_factor, vmin is not None, 0. if vmin is None else vmin,
+              vmax is not None, 0. if vmax is None else vmax, -1 if keepbits is None else keepbits)
+    nrows = int(np.prod(shape[:3]))
+    nthreads = min(cpu_count() or 1, nrows, data.size // ingest_size_per_thread)
+    if nthreads <= 1:
+        lib.pcls_ingest(*args, 0, nrows, *params)
+    else:
+        bounds = np.linspace(0, nrows, nthreads + 1).astype(np.int64)
+        # ctypes releases the GIL during the call, so the row blocks are processed concurrently
+        list(_ingest_threads().map(lambda b: lib.pcls_ingest(*args, int(bounds[b]), int(bounds[b+1]), *params), range(nthreads)))
+    return out
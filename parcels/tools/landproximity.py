@@ -0,0 +1,99 @@
+"""Distance to the nearest land and direction to the nearest ocean, derived from a land mask"""
+import numpy as np
+from scipy.spatial import cKDTree
+
+__all__ = ['distance_to_land']
+
+earth_radius = 1852 * 60 * 180 / np.pi  # consistent with the 1852*60 m per degree of the unit converters
+far_away = 1e20  # distance on levels without land (or, negated, without ocean)
+
+
+def _cartesian(lon, lat, mesh):
+    if mesh == 'spherical':
+        lonr, latr = np.radians(lon), np.radians(lat)
+        return earth_radius * np.stack([np.cos(latr) * np.cos(lonr), np.cos(latr) * np.sin(lonr), np.sin(latr)], axis=-1)
+    return np.stack([lon, lat], axis=-1)
+
+
+def _coastal(mask):
+    """Nodes of mask that have a neighbour (in i or j) outside mask"""
+    coast = np.zeros_like(mask)
+    coast[1:, :] |= mask[1:, :] & ~mask[:-1, :]
+    coast[:-1, :] |= mask[:-1, :] & ~mask[1:, :]
+    coast[:, 1:] |= mask[:, 1:] & ~mask[:, :-1]
+    coast[:, :-1] |= mask[:, :-1] & ~mask[:, 1:]
+    return coast
+
+
+def _nearest(points, targets, mesh):
+    """Distance from each of points to the nearest of targets, and the index of that target"""
+    dist, index = cKDTree(targets).query(points)
+    if mesh == 'spherical':
+        # chord length to great-circle distance
+        dist = 2 * earth_radius * np.arcsin(np.minimum(dist / (2 * earth_radius), 1.))
+    return dist, index
+
+
+def _direction(lon, lat, xyz_from, xyz_to, mesh):
+    """Eastward and northward components of the unit vector from xyz_from to xyz_to"""
+    v = xyz_to - xyz_from
+    if mesh == 'spherical':
+        lonr, latr = np.radians(lon), np.radians(lat)
+        dx = -np.sin(lonr) * v[:, 0] + np.cos(lonr) * v[:, 1]
+        dy = -np.sin(latr) * np.cos(lonr) * v[:, 0] - np.sin(latr) * np.sin(lonr) * v[:, 1] + np.cos(latr) * v[:, 2]
+    else:
+        dx, dy = v[:, 0], v[:, 1]
+    norm = np.hypot(dx, dy)
+    norm[norm == 0] = 1
+    return dx / norm, dy / norm
+
+
+def distance_to_land(landmask, lon, lat, mesh='spherical'):
+    """Signed distance to the coast and direction to the nearest ocean for each node of a (curvilinear) grid,
+    computed with k-d trees of the coastal land and ocean nodes, so that beaching kernels can sample one field
+    instead of searching a ring of points for land.
+
+    The distance is positive at ocean nodes (distance to the nearest land node) and negative at land nodes
+    (minus the distance to the nearest ocean node), in m for a spherical mesh and in mesh units for a flat mesh.
+    Spherical distances are great-circle distances, so they are also correct on curvilinear and polar grids.
+    The direction is the eastward and northward components of a unit vector that points seaward: at land
+    nodes towards the nearest ocean node, and at ocean nodes away from the nearest land node.
+
+    :param landmask: Boolean array of [ydim, xdim] or [zdim, ydim, xdim] that is True on land.
+           3D masks are processed per depth level
+    :param lon: Longitudes of the nodes, as 1D (rectilinear) or [ydim, xdim] (curvilinear) array
+    :param lat: Latitudes of the nodes, as 1D (rectilinear) or [ydim, xdim] (curvilinear) array
+    :param mesh: 'spherical' or 'flat'
+    :return: Tuple of float32 arrays (distance, direction_x, direction_y), with the shape of landmask
+    """
+    landmask = np.asarray(landmask, dtype=bool)
+    if lon.ndim == 1:
+        lon, lat = np.meshgrid(lon, lat)
+    lon, lat = lon.ravel().astype(np.float64), lat.ravel().astype(np.float64)
+    xyz = _cartesian(lon, lat, mesh)
+
+    levels = landmask.reshape((-1, ) + landmask.shape[-2:])
+    out = [np.empty(levels.shape, dtype=np.float32) for _ in range(3)]
+    for k, level in enumerate(levels):
+        land = level.ravel()
+        # the nearest node on the other side of the coast is one that borders this side, which keeps the trees small
+        coast = {True: _coastal(level).ravel(), False: _coastal(~level).ravel()}
+        dist = np.empty(land.size)
+        dirx, diry = np.zeros(land.size), np.zeros(land.size)
+        for on_land, sign in [(False, 1), (True, -1)]:
+            points = np.where(land == on_land)[0]
+            targets = np.where(coast[not on_land])[0]
+            if points.size == 0:
+                continue
+            if targets.size == 0:
+                dist[points] = sign * far_away
+                continue
+            d, i = _nearest(xyz[points], xyz[targets], mesh)
+            dist[points] = sign * d
+            # seaward: towards the nearest ocean node from land, away from the nearest land node in the ocean
+            dirx[points], diry[points] = _direction(lon[points], lat[points], xyz[points], xyz[targets[i]], mesh)
+            dirx[points] *= -sign
+            diry[points] *= -sign
+        for o, v in zip(out, [dist, dirx, diry]):
+            o[k] = v.reshape(level.shape)
+    return tuple(o.reshape(landmask.shape) for o in out)
@@ -0,0 +1,152 @@
+"""Accounting of the memory held by fields, grids, particles and output"""
+import os
+
+try:
+    import resource
+except ImportError:
+    resource = None
+try:
+    from mpi4py import MPI
+except:
+    MPI = None
+
+from parcels.tools.loggers import logger
+
+__all__ = ['memory_report', 'print_memory_report', 'log_memory_usage']
+
+_high_water = {'accounted': 0}
+
+
+def _psutil_process():
+    """psutil handle on this process, or None if psutil is not installed"""
+    try:
+        import psutil
+    except ImportError:
+        return None
+    return psutil.Process(os.getpid())
+
+
+def _rss():
+    """Resident set size of this process, in bytes (0 if it cannot be determined)"""
+    process = _psutil_process()
+    if process is not None:
+        return process.memory_info().rss
+    try:
+        with open('/proc/self/statm') as f:
+            return int(f.read().split()[1]) * os.sysconf('SC_PAGE_SIZE')
+    except (OSError, ValueError, IndexError, AttributeError):
+        logger.warning_once('Install psutil to include the resident set size in memory reports')
+        return 0
+
+
+def _peak_rss():
+    """High-water mark of the resident set size of this process, in bytes (0 if it cannot be determined)"""
+    if resource is None:  # Windows
+        process = _psutil_process()
+        return 0 if process is None else process.memory_info().peak_wset
+    maxrss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return maxrss if os.uname().sysname == 'Darwin' else maxrss * 1024
+
+
+def _local_report(pset=None, fieldset=None, output_file=None):
+    if fieldset is None and pset is not None:
+        fieldset = pset.fieldset
+    report = {'fields': {}, 'grids': {}, 'particles': {}, 'output': {}}
+    accounted = 0
+    if fieldset is not None:
+        fs_usage = fieldset.memory_usage()
+        report['fields'], report['grids'] = fs_usage['fields'], fs_usage['grids']
+        accounted += fs_usage['bytes']
+    if pset is not None:
+        report['particles'] = pset.collection.memory_usage()
+        accounted += sum(report['particles'].values())
+    if output_file is not None:
+        report['output'] = output_file.memory_usage()
+        accounted += report['output']['staged_bytes_in_memory']
+    _high_water['accounted'] = max(_high_water['accounted'], accounted)
+    report['accounted'] = accounted
+    report['accounted_high_water'] = _high_water['accounted']
+    report['rss'] = _rss()
+    report['rss_high_water'] = max(_peak_rss(), report['rss'])  # the kernel updates the peak lazily
+    return report
+
+
+def memory_report(pset=None, fieldset=None, output_file=None, gather=True):
+    """Bytes held by the fields (loaded data, chunks and time slices, and the part of it that is halo), grids
+    (coordinates and the number of chunks in each load_chunk state), particle variables and output staging,
+    with the resident set size of the process and its high-water mark.
+
+    :param pset: ParticleSet whose particle variables (and fieldset, if fieldset is not given) are reported
+    :param fieldset: FieldSet to report (default: the FieldSet of pset)
+    :param output_file: ParticleFile whose staged output is reported
+    :param gather: Boolean whether, under MPI, to gather the reports of all ranks on rank 0 (so all ranks have to
+           call this function). The report on rank 0 then has a 'ranks' list with the per-rank reports and
+           'total' and 'max' dictionaries with the sum and maximum over ranks of the accounted and rss bytes;
+           other ranks get None
+    :return: Dictionary with 'fields', 'grids', 'particles', 'output', 'accounted' (the sum of all accounted
+             bytes), 'accounted_high_water', 'rss' and 'rss_high_water'
+    """
+    report = _local_report(pset, fieldset, output_file)
+    if not (gather and MPI and MPI.COMM_WORLD.Get_size() > 1):
+        return report
+    reports = MPI.COMM_WORLD.gather(report, root=0)
+    if MPI.COMM_WORLD.Get_rank() > 0:
+        return None
+    keys = ['accounted', 'accounted_high_water', 'rss', 'rss_high_water']
+    return {'ranks': reports,
+            'total': {k: sum(r[k] for r in reports) for k in keys},
+            'max': {k: max(r[k] for r in reports) for k in keys}}
+
+
+def _mb(nbytes):
+    return '%.1f MB' % (nbytes / 2.**20)
+
+
+def _format_local(report):
+    lines = []
+    for name, f in sorted(report['fields'].items(), key=lambda item: -item[1]['bytes']):
+        compressed = ', compressed %s' % _mb(f['compressed_bytes']) if f.get('compressed_bytes') else ''
+        lines.append('  field %-20s %12s  (%d time slices, chunks %s%s, halo %s)'
+                     % (name, _mb(f['bytes']), f['time_slices'], _mb(f['chunk_bytes']), compressed, _mb(f['halo_bytes'])))
+    for igrid, g in report['grids'].items():
+        states = ', '.join('%s: %d' % s for s in g['chunks'].items() if s[1] > 0)
+        lines.append('  grid %-21d %12s  (fields %s; chunks %s)'
+                     % (igrid, _mb(g['bytes']), ', '.join(g['fields']), states if states else 'none'))
+    for name, nbytes in sorted(report['particles'].items(), key=lambda item: -item[1]):
+        lines.append('  particle variable %-12s %8s' % (name, _mb(nbytes)))
+    if report['output']:
+        lines.append('  output staging %23s in memory, %s in %d files on disk, export needs %s'
+                     % (_mb(report['output']['staged_bytes_in_memory']), _mb(report['output']['staged_bytes_on_disk']),
+                        report['output']['staged_files'], _mb(report['output']['export_bytes'])))
+    lines.append('  accounted %28s  (high-water %s)' % (_mb(report['accounted']), _mb(report['accounted_high_water'])))
+    lines.append('  resident set size %20s  (high-water %s)' % (_mb(report['rss']), _mb(report['rss_high_water'])))
+    return lines
+
+
+def print_memory_report(report):
+    """Prints a report of memory_report(), largest fields and particle variables first"""
+    if report is None:
+        return
+    if 'ranks' in report:
+        for rank, r in enumerate(report['ranks']):
+            print('Memory of rank %d' % rank)
+            print('\n'.join(_format_local(r)))
+        print('All %d ranks: accounted %s (max %s per rank), resident set size %s (max %s per rank)'
+              % (len(report['ranks']), _mb(report['total']['accounted']), _mb(report['max']['accounted']),
+                 _mb(report['total']['rss']), _mb(report['max']['rss'])))
+    else:
+        print('Memory')
+        print('\n'.join(_format_local(report)))
+
+
+def log_memory_usage(pset=None, fieldset=None, output_file=None):
+    """Logs a one-line summary of the memory of this rank (without MPI communication), so that it can be used
+    as one of the postIterationCallbacks of ParticleSet.execute() to log the memory periodically"""
+    report = _local_report(pset, fieldset, output_file)
+    largest = max(report['fields'].items(), key=lambda item: item[1]['bytes'], default=None)
+    rank = MPI.COMM_WORLD.Get_rank() if MPI else 0
+    logger.info('Memory (rank %d): fields %s (largest %s), particles %s, rss %s (high-water %s)'
+                % (rank, _mb(sum(f['bytes'] for f in report['fields'].values())),
+                   '%s %s' % (largest[0], _mb(largest[1]['bytes'])) if largest else 'none',
+                   _mb(sum(report['particles'].values())), _mb(report['rss']), _mb(report['rss_high_water'])))
+    return report
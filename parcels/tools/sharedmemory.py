@@ -0,0 +1,180 @@
+"""Ring of field time slices in POSIX shared memory, for coupling Parcels online to a running model"""
+import json
+import os
+import time as time_module
+
+import numpy as np
+try:
+    from multiprocessing import shared_memory
+    from multiprocessing import resource_tracker
+except ImportError:  # Python < 3.8
+    shared_memory = None
+
+__all__ = ['SharedMemoryRing']
+
+_MAGIC = 0x50524e47  # 'PRNG'
+_HEADER_BYTES = 64
+_created = set()  # names of the rings created by this process
+
+
+class SharedMemoryRing(object):
+    """Ring of `nslots` time slices of float32 field data in a POSIX shared memory block, written by a producer
+    (e.g. an ocean model) and read by Parcels without copying (see FieldSet.from_shared_memory()).
+
+    The block starts with a header of int64 counters: the number of slices `published` by the producer, the index
+    of the first slice that the consumer still needs (`released` slices before it), and a `closed` flag. It is
+    followed by a JSON layout (the variable names, the grid coordinates and the times of all slices that will be
+    published) and the data, of shape [nvars, nslots+1, zdim, ydim, xdim]. Slice k is written to slot k % nslots,
+    and slot 0 is mirrored in the extra slot nslots, so that any two consecutive slices are a contiguous view.
+
+    The handshake is lock-free, with one writer per counter: the producer blocks in publish() while its slot still
+    holds a slice that the consumer needs, and publishes a slice by incrementing `published` after writing it;
+    the consumer blocks in window() until the slices it asks for are published, and increments `released`.
+
+    A producer creates the ring with SharedMemoryRing.create(); a consumer attaches to it by name.
+
+    :param name: Name of the shared memory block
+    :param create_layout: Layout of a new block (internal; use SharedMemoryRing.create())
+    """
+
+    def __init__(self, name, create_layout=None):
+        if shared_memory is None:
+            raise NotImplementedError('SharedMemoryRing requires Python >= 3.8 (multiprocessing.shared_memory)')
+        self.name = name
+        self.owner = create_layout is not None
+        if self.owner:
+            layout = json.dumps(create_layout).encode()
+            layout_bytes = (len(layout) + 7) // 8 * 8
+            self.shm = shared_memory.SharedMemory(name=name, create=True,
+                                                  size=_HEADER_BYTES + layout_bytes + self._data_bytes(create_layout))
+            self.shm.buf[_HEADER_BYTES:_HEADER_BYTES + len(layout)] = layout
+            self.layout = create_layout
+            _created.add(name)
+        else:
+            self.shm = shared_memory.SharedMemory(name=name)
+            if name not in _created and os.name == 'posix':  # only the producer may unlink the block when its process ends
+                # the resource tracker registers POSIX blocks under their name with a leading slash
+                resource_tracker.unregister('/' + self.shm.name, 'shared_memory')
+        self.header = np.ndarray((_HEADER_BYTES // 8,), dtype=np.int64, buffer=self.shm.buf)
+        if self.owner:
+            self.header[:] = 0
+            self.header[1] = len(layout)
+            self.header[0] = _MAGIC
+        else:
+            if self.header[0] != _MAGIC:
+                raise RuntimeError('Shared memory block %s is not a SharedMemoryRing' % name)
+            self.layout = json.loads(bytes(self.shm.buf[_HEADER_BYTES:_HEADER_BYTES + int(self.header[1])]).decode())
+            layout_bytes = (int(self.header[1]) + 7) // 8 * 8
+        self.nslots = self.layout['nslots']
+        self.variables = self.layout['variables']
+        self.time = np.array(self.layout['time'], dtype=np.float64)
+        shape = tuple(self.layout['shape'])
+        offset = _HEADER_BYTES + layout_bytes
+        self.slot_time = np.ndarray((self.nslots + 1,), dtype=np.float64, buffer=self.shm.buf, offset=offset)
+        self.data = np.ndarray((len(self.variables), self.nslots + 1) + shape, dtype=np.float32,
+                               buffer=self.shm.buf, offset=offset + self.slot_time.nbytes)
+
+    @staticmethod
+    def _data_bytes(layout):
+        return 8 * (layout['nslots'] + 1) + 4 * len(layout['variables']) * (layout['nslots'] + 1) * int(np.prod(layout['shape']))
+
+    @classmethod
+    def create(cls, name, variables, lon, lat, time, depth=None, nslots=4, mesh='spherical'):
+        """Creates a ring as producer
+
+        :param name: Name of the shared memory block
+        :param variables: List of the names of the variables of each slice (e.g. ['U', 'V'])
+        :param lon: Longitudes of the grid (1D, or 2D for a curvilinear grid)
+        :param lat: Latitudes of the grid (1D, or 2D for a curvilinear grid)
+        :param time: Times (in seconds) of all slices that will be published, in increasing order
+        :param depth: Depths of the grid (default a single level at 0)
+        :param nslots: Number of slices that the ring holds (at least 2)
+        :param mesh: Mesh of the grid ('spherical' or 'flat')
+        """
+        if nslots < 2:
+            raise ValueError('A SharedMemoryRing needs at least 2 slots')
+        lon, lat = np.asarray(lon), np.asarray(lat)
+        depth = np.zeros(1) if depth is None else np.asarray(depth)
+        ydim, xdim = (len(lat), len(lon)) if lon.ndim == 1 else lon.shape
+        layout = {'variables': list(variables), 'nslots': int(nslots), 'shape': [len(depth), ydim, xdim],
+                  'lon': lon.tolist(), 'lat': lat.tolist(), 'depth': depth.tolist(),
+                  'time': [float(t) for t in time], 'mesh': mesh}
+        return cls(name, create_layout=layout)
+
+    @property
+    def published(self):
+        return int(self.header[2])
+
+    @property
+    def released(self):
+        return int(self.header[3])
+
+    @property
+    def closed(self):
+        return bool(self.header[4])
+
+    @staticmethod
+    def _wait(condition, timeout, what):
+        tic = time_module.perf_counter()
+        pause = 1e-4
+        while not condition():
+            if timeout is not None and time_module.perf_counter() - tic > timeout:
+                raise TimeoutError('Timed out after %g s waiting for %s' % (timeout, what))
+            time_module.sleep(pause)
+            pause = min(2 * pause, 1e-2)
+
+    def publish(self, data, timeout=None):
+        """Writes the next slice (producer), waiting until its slot is no longer needed by the consumer
+
+        :param data: Dictionary of the arrays (of shape [zdim, ydim, xdim] or [ydim, xdim]) of all variables
+        :param timeout: Maximum number of seconds to wait (default: no limit)
+        """
+        k = self.published
+        if k >= len(self.time):
+            raise RuntimeError('All %d slices of SharedMemoryRing %s have been published' % (len(self.time), self.name))
+        self._wait(lambda: k < self.released + self.nslots, timeout, 'the consumer to release slice %d' % (k - self.nslots))
+        slot = k % self.nslots
+        for v, name in enumerate(self.variables):
+            self.data[v, slot] = np.reshape(data[name], self.data.shape[2:])
+            if slot == 0:
+                self.data[v, self.nslots] = self.data[v, 0]
+        self.slot_time[slot] = self.time[k]
+        if slot == 0:
+            self.slot_time[self.nslots] = self.time[k]
+        self.header[2] = k + 1
+
+    def window(self, variable, k, timeout=None):
+        """View of slices k and k+1 of a variable (consumer), of shape [2, zdim, ydim, xdim], which releases the
+        slices before k and waits until slice k+1 is published
+
+        :param variable: Name of the variable
+        :param k: Index of the first slice
+        :param timeout: Maximum number of seconds to wait (default: no limit)
+        """
+        if k < self.released:
+            raise RuntimeError('Slice %d of SharedMemoryRing %s has already been released' % (k, self.name))
+        self.header[3] = k
+        self._wait(lambda: self.published > k + 1 or self.closed, timeout, 'slice %d to be published' % (k + 1))
+        if self.published <= k + 1:
+            raise RuntimeError('SharedMemoryRing %s was closed before slice %d was published' % (self.name, k + 1))
+        slot = k % self.nslots
+        if self.slot_time[slot] != self.time[k] or self.slot_time[slot + 1] != self.time[k + 1]:
+            raise RuntimeError('Slots %d and %d of SharedMemoryRing %s do not hold slices %d and %d'
+                               % (slot, slot + 1, self.name, k, k + 1))
+        return self.data[self.variables.index(variable), slot:slot + 2]
+
+    def close(self):
+        """Detaches from the ring; the producer signals the end of the run and removes the block"""
+        if self.shm is None:
+            return
+        if self.owner:
+            self.header[4] = 1
+        self.header = self.slot_time = self.data = None
+        if self.owner:
+            self.shm.unlink()
+            _created.discard(self.name)
+        try:
+            self.shm.close()
+        except BufferError:  # views of the slices are still in use (e.g. as Field.data); unmapped when they are freed
+            return
+        self.shm = None
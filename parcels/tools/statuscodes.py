@@ -1,7 +1,7 @@
 """Collection of pre-built recovery kernels"""
 
 
-__all__ = ['StateCode', 'OperationCode', 'ErrorCode',
+__all__ = ['StateCode', 'OperationCode', 'ErrorCode', 'BoundaryPolicy',
            'FieldSamplingError', 'FieldOutOfBoundError', 'TimeExtrapolationError',
            'KernelError', 'OutOfBoundsError', 'ThroughSurfaceError', 'OutOfTimeError',
            'recovery_map']
@@ -26,6 +26,17 @@ class ErrorCode(object):
     ErrorTimeExtrapolation = 7
 
 
+class BoundaryPolicy(object):
+    """Policies for particles that raise ErrorOutOfBounds or ErrorThroughSurface, which are applied
+    inside the kernel loop (see FieldSet.set_boundary_policy). Recover leaves the particle to the recovery kernels"""
+    Recover = 0
+    Reflect = 1
+    Clamp = 2
+    Periodic = 3
+    Delete = 4
+    Freeze = 5
+
+
 class DaskChunkingError(RuntimeError):
     """
     Error indicating to the user that something with setting up Dask and chunked fieldsets went wrong.
@@ -0,0 +1,131 @@
+"""Recording of execution spans, exported in the Chrome trace event format (for Perfetto and chrome://tracing)"""
+import json
+import os
+import threading
+import time
+from contextlib import contextmanager
+try:
+    from mpi4py import MPI
+except:
+    MPI = None
+
+__all__ = ['Tracer', 'tracer', 'start_tracing', 'stop_tracing', 'export_trace']
+
+
+class Tracer(object):
+    """Collects timed spans (kernel compilation and execution, field chunk loads, output writes, recovery passes,
+    MPI collectives) when enabled. Every span records the MPI rank as process and the Python thread as thread,
+    with timestamps in microseconds since the epoch, so that the traces of all ranks share one time axis.
+
+    Spans are only recorded between start() and stop(); when disabled, span() costs one attribute lookup.
+    """
+    def __init__(self):
+        self.enabled = False
+        self._events = []
+        self._lock = threading.Lock()
+        # perf_counter() is precise but has an arbitrary origin; this offset puts it on the epoch of time.time()
+        self._epoch = time.time() - time.perf_counter()
+
+    @staticmethod
+    def now():
+        return time.perf_counter()
+
+    @staticmethod
+    def rank():
+        return MPI.COMM_WORLD.Get_rank() if MPI else 0
+
+    def start(self, clear=True):
+        if clear:
+            self.clear()
+        self.enabled = True
+
+    def stop(self):
+        self.enabled = False
+
+    def clear(self):
+        with self._lock:
+            self._events = []
+
+    def add_span(self, name, cat, start, stop=None, **args):
+        """Records a span from start to stop (both now() values; stop defaults to now).
+        Arguments that are not JSON scalars (e.g. file paths) are only converted to strings when the span is recorded"""
+        if not self.enabled:
+            return
+        stop = self.now() if stop is None else stop
+        event = {'name': name, 'cat': cat, 'ph': 'X', 'ts': (self._epoch + start) * 1e6, 'dur': (stop - start) * 1e6,
+                 'pid': self.rank(), 'tid': threading.get_ident()}
+        if args:
+            event['args'] = {k: v if isinstance(v, (str, int, float, bool)) or v is None else str(v) for k, v in args.items()}
+        with self._lock:
+            self._events.append(event)
+
+    @contextmanager
+    def span(self, name, cat, **args):
+        """Context manager that records the enclosed block as one span"""
+        if not self.enabled:
+            yield
+            return
+        tic = self.now()
+        try:
+            yield
+        finally:
+            self.add_span(name, cat, tic, **args)
+
+    @property
+    def events(self):
+        with self._lock:
+            return list(self._events)
+
+    def _metadata(self, events):
+        meta = []
+        for pid in sorted(set(e['pid'] for e in events)):
+            meta.append({'name': 'process_name', 'ph': 'M', 'pid': pid, 'args': {'name': 'rank %d' % pid}})
+        threads = {t.ident: t.name for t in threading.enumerate()}
+        for pid, tid in sorted(set((e['pid'], e['tid']) for e in events)):
+            if pid == self.rank() and tid in threads:
+                meta.append({'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': tid, 'args': {'name': threads[tid]}})
+        return meta
+
+    def export(self, filename):
+        """Writes the recorded spans as Chrome trace JSON. With MPI, the spans of all ranks are gathered
+        and written by rank 0, so this has to be called on all ranks.
+
+        :param filename: Name of the JSON file, which can be opened in https://ui.perfetto.dev
+        """
+        events = self.events
+        if MPI and MPI.COMM_WORLD.Get_size() > 1:
+            gathered = MPI.COMM_WORLD.gather(events, root=0)
+            if MPI.COMM_WORLD.Get_rank() > 0:
+                return
+            events = [e for rank_events in gathered for e in rank_events]
+        events.sort(key=lambda e: e['ts'])
+        dirname = os.path.dirname(os.path.abspath(filename))
+        if not os.path.exists(dirname):
+            os.makedirs(dirname)
+        with open(filename, 'w') as f:
+            # span arguments may be numpy scalars
+            json.dump({'traceEvents': self._metadata(events) + events, 'displayTimeUnit': 'ms'}, f,
+                      default=lambda o: o.item() if hasattr(o, 'item') else str(o))
+
+
+tracer = Tracer()
+
+
+def start_tracing(clear=True):
+    """Starts recording execution spans in the global tracer
+
+    :param clear: Boolean whether to discard previously recorded spans
+    """
+    tracer.start(clear)
+
+
+def stop_tracing(filename=None):
+    """Stops recording execution spans and, if filename is given, exports them as Chrome trace JSON"""
+    tracer.stop()
+    if filename is not None:
+        tracer.export(filename)
+
+
+def export_trace(filename):
+    """Exports the execution spans recorded so far as Chrome trace JSON (see Tracer.export)"""
+    tracer.export(filename)
@@ -0,0 +1,62 @@
+"""Benchmark of the JIT index search on a distorted curvilinear (ORCA-like) grid,
+with and without the precomputed bilinear inverse-map coefficients of CurvilinearGrid.set_search_coefs()"""
+import math
+import time as ostime
+from argparse import ArgumentParser
+
+import numpy as np
+
+from parcels import FieldSet, ParticleSet, JITParticle, Variable
+
+
+class SampleParticle(JITParticle):
+    u = Variable('u', dtype=np.float32)
+
+
+def SampleU(particle, fieldset, time):
+    particle.u = fieldset.U[time, particle.depth, particle.lat, particle.lon]
+
+
+def Drift(particle, fieldset, time):
+    # small displacement, so that the search starts from a nearby (but not always the same) cell
+    particle.lon += 0.05 * math.sin(particle.lat)
+    particle.lat += 0.05 * math.cos(particle.lon)
+
+
+def distorted_fieldset(xdim, ydim):
+    i, j = np.meshgrid(np.arange(xdim, dtype=np.float32), np.arange(ydim, dtype=np.float32))
+    # rotated and sheared grid lines, similar to the northern part of a tripolar grid
+    lon = -180. + 360. * i / (xdim-1) + 3. * np.sin(2 * np.pi * j / (ydim-1))
+    lat = -70. + 140. * j / (ydim-1) + 2. * np.sin(2 * np.pi * i / (xdim-1))
+    U = np.random.rand(ydim, xdim).astype(np.float32)
+    return FieldSet.from_data({'U': U, 'V': U}, {'lon': lon, 'lat': lat}, mesh='spherical')
+
+
+def run(use_search_coefs, xdim, ydim, npart, nsteps):
+    fieldset = distorted_fieldset(xdim, ydim)
+    fieldset.U.grid.set_search_coefs(use_search_coefs)
+    rng = np.random.RandomState(1234)
+    pset = ParticleSet(fieldset, SampleParticle, lon=rng.uniform(-150, 150, npart), lat=rng.uniform(-50, 50, npart))
+    kernel = pset.Kernel(SampleU) + pset.Kernel(Drift)
+    pset.execute(kernel, runtime=1, dt=1)  # compile, load chunks and build the coefficient table
+
+    tic = ostime.time()
+    pset.execute(kernel, runtime=nsteps, dt=1)
+    elapsed = ostime.time() - tic
+    coefs = fieldset.U.grid.search_coefs
+    print("search coefficients %-3s (table %6.1f MB): %d samples in %.3f s -> %.3e samples/s"
+          % ('on' if use_search_coefs else 'off', 0 if coefs is None else coefs.nbytes / 1024**2,
+             npart*nsteps, elapsed, npart*nsteps/elapsed))
+    return pset.u
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description="Benchmark of the curvilinear index search")
+    parser.add_argument("-x", "--xdim", dest="xdim", type=int, default=1442, help="zonal size of the grid")
+    parser.add_argument("-y", "--ydim", dest="ydim", type=int, default=1021, help="meridional size of the grid")
+    parser.add_argument("-n", "--npart", dest="npart", type=int, default=100000, help="number of particles")
+    parser.add_argument("-s", "--nsteps", dest="nsteps", type=int, default=20, help="number of sampling steps")
+    args = parser.parse_args()
+
+    u = [run(use_search_coefs, args.xdim, args.ydim, args.npart, args.nsteps) for use_search_coefs in [False, True]]
+    print("max difference in sampled value: %g" % np.max(np.abs(u[0] - u[1])))
@@ -0,0 +1,73 @@
+"""Benchmark of huge-page backed field storage: sampling throughput of randomly placed particles on a large 3D field.
+
+Run each policy in a separate process, so that dTLB misses can be counted per policy, e.g.
+    perf stat -e dTLB-loads,dTLB-load-misses python benchmark_hugepages.py -p thp
+Without a policy argument, all policies are run in turn and only throughput is reported.
+"""
+import subprocess
+import sys
+import time as ostime
+from argparse import ArgumentParser
+
+import numpy as np
+
+from parcels import FieldSet, ParticleSet, JITParticle, Variable
+from parcels.tools.allocation import set_hugepage_policy, hugepage_policies
+
+
+class SampleParticle(JITParticle):
+    u = Variable('u', dtype=np.float32)
+    v = Variable('v', dtype=np.float32)
+
+
+def SampleUV(particle, fieldset, time):
+    particle.u = fieldset.U[time, particle.depth, particle.lat, particle.lon]
+    particle.v = fieldset.V[time, particle.depth, particle.lat, particle.lon]
+
+
+def Jump(particle, fieldset, time):
+    # move each particle to a distant row, so that consecutive samples hit different pages
+    particle.lat = (particle.lat + 37.3) % 79.
+    particle.lon = (particle.lon + 113.7) % 359.
+    particle.depth = (particle.depth + 1711.) % 4900.
+
+
+def run(policy, xdim, ydim, zdim, npart, nsteps):
+    set_hugepage_policy(policy)
+    lon = np.linspace(0., 360., xdim, dtype=np.float32)
+    lat = np.linspace(-80., 80., ydim, dtype=np.float32)
+    depth = np.linspace(0., 5000., zdim, dtype=np.float32)
+    U = np.random.rand(zdim, ydim, xdim).astype(np.float32)
+    fieldset = FieldSet.from_data({'U': U, 'V': U}, {'lon': lon, 'lat': lat, 'depth': depth}, mesh='flat')
+
+    rng = np.random.RandomState(1234)
+    pset = ParticleSet(fieldset, SampleParticle, lon=rng.uniform(0, 359, npart),
+                       lat=rng.uniform(-79, 79, npart), depth=rng.uniform(0, 4900, npart))
+    kernel = pset.Kernel(SampleUV) + pset.Kernel(Jump)
+    pset.execute(kernel, runtime=1, dt=1)  # compile and load chunks
+
+    tic = ostime.time()
+    pset.execute(kernel, runtime=nsteps, dt=1)
+    elapsed = ostime.time() - tic
+    nbytes = fieldset.U.data_chunks[0].nbytes / 1024**3
+    print("policy %-8s: field %.2f GB, %d samples in %.3f s -> %.3e samples/s"
+          % (policy, nbytes, 2*npart*nsteps, elapsed, 2*npart*nsteps/elapsed))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description="Benchmark of sampling a large 3D field with and without huge pages")
+    parser.add_argument("-p", "--policy", dest="policy", type=str, default='all', help="huge page policy: none, thp, hugetlb or all (default)")
+    parser.add_argument("-x", "--xdim", dest="xdim", type=int, default=2160, help="zonal size of the field")
+    parser.add_argument("-y", "--ydim", dest="ydim", type=int, default=1080, help="meridional size of the field")
+    parser.add_argument("-z", "--zdim", dest="zdim", type=int, default=100, help="vertical size of the field")
+    parser.add_argument("-n", "--npart", dest="npart", type=int, default=100000, help="number of particles")
+    parser.add_argument("-s", "--nsteps", dest="nsteps", type=int, default=20, help="number of sampling steps")
+    args = parser.parse_args()
+
+    if args.policy == 'all':
+        for policy in hugepage_policies:
+            cmd = [sys.executable, __file__, '-p', str(policy).lower(), '-x', str(args.xdim), '-y', str(args.ydim),
+                   '-z', str(args.zdim), '-n', str(args.npart), '-s', str(args.nsteps)]
+            subprocess.check_call(cmd)
+    else:
+        run(None if args.policy == 'none' else args.policy, args.xdim, args.ydim, args.zdim, args.npart, args.nsteps)
@@ -0,0 +1,55 @@
+"""Benchmark of the JIT loop with and without software prefetching, for RK4 advection on a time-varying field.
+Use a field that does not fit in the last-level cache (e.g. -x 4000 -y 7000) to see the effect of prefetching."""
+import time as ostime
+from argparse import ArgumentParser
+
+import numpy as np
+
+from parcels import FieldSet, ParticleSet, JITParticle, AdvectionRK4
+
+
+def moving_eddies_fieldset(xdim, ydim, tdim):
+    lon = np.linspace(0., 4e5, xdim, dtype=np.float32)
+    lat = np.linspace(0., 7e5, ydim, dtype=np.float32)
+    time = np.arange(tdim) * 86400.
+    x, y = np.meshgrid(lon, lat)
+    U = np.zeros((tdim, ydim, xdim), dtype=np.float32)
+    V = np.zeros((tdim, ydim, xdim), dtype=np.float32)
+    for t in range(tdim):
+        phase = 2 * np.pi * t / tdim
+        U[t] = 0.1 * np.sin(np.pi * y / 7e5 + phase) * np.cos(np.pi * x / 4e5)
+        V[t] = -0.1 * np.cos(np.pi * y / 7e5 + phase) * np.sin(np.pi * x / 4e5)
+    return FieldSet.from_data({'U': U, 'V': V}, {'lon': lon, 'lat': lat, 'time': time}, mesh='flat')
+
+
+def run(prefetch_distance, fieldset, npart, runtime, dt):
+    rng = np.random.RandomState(1234)
+    pset = ParticleSet(fieldset, JITParticle, lon=rng.uniform(1e5, 3e5, npart), lat=rng.uniform(1e5, 6e5, npart))
+    kernel = pset.Kernel(AdvectionRK4, prefetch_distance=prefetch_distance)
+    pset.execute(kernel, runtime=dt, dt=dt)  # compile and load chunks
+
+    tic = ostime.time()
+    pset.execute(kernel, runtime=runtime, dt=dt)
+    elapsed = ostime.time() - tic
+    nsteps = npart * runtime / dt
+    print("prefetch distance %2d: %d particle steps in %.3f s -> %.3e steps/s"
+          % (prefetch_distance, nsteps, elapsed, nsteps / elapsed))
+    return pset.lon, pset.lat
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description="Benchmark of software prefetching in the JIT loop")
+    parser.add_argument("-x", "--xdim", dest="xdim", type=int, default=400, help="zonal size of the field")
+    parser.add_argument("-y", "--ydim", dest="ydim", type=int, default=700, help="meridional size of the field")
+    parser.add_argument("-t", "--tdim", dest="tdim", type=int, default=10, help="number of time snapshots")
+    parser.add_argument("-n", "--npart", dest="npart", type=int, default=100000, help="number of particles")
+    parser.add_argument("-r", "--runtime", dest="runtime", type=float, default=5*86400., help="runtime in seconds")
+    parser.add_argument("-d", "--dt", dest="dt", type=float, default=300., help="time step in seconds")
+    parser.add_argument("-p", "--prefetch-distance", dest="prefetch_distance", type=int, default=8, help="prefetch distance in particles")
+    args = parser.parse_args()
+
+    results = []
+    for prefetch_distance in [0, args.prefetch_distance]:
+        fieldset = moving_eddies_fieldset(args.xdim, args.ydim, args.tdim)
+        results.append(run(prefetch_distance, fieldset, args.npart, args.runtime, args.dt))
+    print("max difference in position: %g" % max(np.max(np.abs(r[i] - results[0][i])) for r in results for i in range(2)))
@@ -1,6 +1,6 @@
-from parcels import (FieldSet, Field, ScipyParticle, JITParticle, ErrorCode, StateCode,
-                     AdvectionEE, AdvectionRK4, AdvectionRK45, AdvectionRK4_3D,
-                     AdvectionAnalytical, AdvectionDiffusionM1, AdvectionDiffusionEM)
+from parcels import (FieldSet, Field, ScipyParticle, JITParticle, ErrorCode, StateCode, Variable,
+                     AdvectionEE, AdvectionRK4, AdvectionRK45, AdvectionRK4_3D, AdvectionRK4_IndexSpace,
+                     AdvectionAnalytical, AdvectionDiffusionM1, AdvectionDiffusionEM, FlowMap)
 from parcels import ParticleSetSOA, ParticleFileSOA, KernelSOA  # noqa
 from parcels import ParticleSetAOS, ParticleFileAOS, KernelAOS  # noqa
 import numpy as np
@@ -307,6 +307,35 @@ def test_stationary_eddy(pset_mode, fieldset_stationary, mode, method, rtol, dif
     assert np.allclose(pset.lat, exp_lat, rtol=rtol)
 
 
+@pytest.mark.parametrize('pset_mode', ['soa', 'aos'])
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('curvilinear', [False, True])
+def test_stationary_eddy_index_space(pset_mode, fieldset_stationary, mode, curvilinear, npart=3):
+    fieldset = fieldset_stationary
+    if curvilinear:
+        lons, lats = np.meshgrid(fieldset.U.grid.lon, fieldset.U.grid.lat)
+        dimensions = {'lon': lons, 'lat': lats, 'time': fieldset.U.grid.time}
+        fieldset = FieldSet.from_data({'U': fieldset.U.data, 'V': fieldset.V.data}, dimensions, mesh='flat')
+
+    class IndexSpaceParticle(ptype[mode]):
+        xsi = Variable('xsi', dtype=np.float64, to_write=False)
+        eta = Variable('eta', dtype=np.float64, to_write=False)
+
+    lon = np.linspace(12000, 21000, npart)
+    lat = np.linspace(12500, 12500, npart)
+    pset = pset_type[pset_mode]['pset'](fieldset, pclass=IndexSpaceParticle, lon=lon, lat=lat)
+    endtime = delta(hours=6).total_seconds()
+    pset.execute(AdvectionRK4_IndexSpace, dt=delta(minutes=3), endtime=endtime)
+    exp_lon = [truth_stationary(x, y, endtime)[0] for x, y, in zip(lon, lat)]
+    exp_lat = [truth_stationary(x, y, endtime)[1] for x, y, in zip(lon, lat)]
+    assert np.allclose(pset.lon, exp_lon, rtol=1e-5)
+    assert np.allclose(pset.lat, exp_lat, rtol=1e-5)
+
+    pset = pset_type[pset_mode]['pset'](fieldset, pclass=ptype[mode], lon=lon, lat=lat)
+    with pytest.raises(NotImplementedError):
+        pset.execute(AdvectionRK4_IndexSpace, dt=delta(minutes=3), endtime=endtime)
+
+
 @pytest.mark.parametrize('pset_mode', ['soa', 'aos'])
 @pytest.mark.parametrize('mode', ['scipy', 'jit'])
 def test_stationary_eddy_vertical(pset_mode, mode, npart=1):
@@ -506,3 +535,36 @@ def test_uniform_analytical(pset_mode, mode, u, v, w, direction, tmpdir):
     assert np.allclose(times, timeref)
     lons = dataset.variables['lon'][:]
     assert np.allclose(lons, x0+direction*u*np.arange(0, 5))
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+def test_flowmap_periodic(mode, period=40.):
+    lon = np.linspace(0, 100, 51, dtype=np.float32)
+    lat = np.linspace(0, 100, 51, dtype=np.float32)
+    time = np.arange(0, period, 10.)
+    x, y = np.meshgrid(lon, lat)
+    U = np.array([1 + 0.5 * np.sin(2 * np.pi * t / period) * y / 100. for t in time], dtype=np.float32)
+    V = np.array([0.2 * x / 100. for t in time], dtype=np.float32)
+    fieldset = FieldSet.from_data({'U': U, 'V': V}, {'lon': lon, 'lat': lat, 'time': time},
+                                  mesh='flat', time_periodic=period)
+
+    flowmap = FlowMap(fieldset, lon=np.linspace(10, 50, 41), lat=np.linspace(10, 50, 41), horizon=20, dt=1,
+                      pclass=ptype[mode], starttime=5)
+    assert not np.isnan(flowmap.end_lon).any()
+
+    np.random.seed(1234)
+    plon, plat = np.random.uniform(15, 45, 20), np.random.uniform(15, 45, 20)
+    err = flowmap.estimate_error(plon, plat, time=5 + 2 * period)
+    assert np.all(err < 1e-3)
+
+    end_lon, end_lat = flowmap.propagate([5, 30], [30, 30])
+    assert np.isnan(end_lon[0]) and np.isnan(end_lat[0])
+    assert end_lon[1] > 30 + 20
+    with pytest.raises(ValueError):
+        flowmap.propagate(plon, plat, time=5 + period / 2)
+
+    matrix = flowmap.transport_matrix(np.linspace(0, 100, 11), np.linspace(0, 100, 11))
+    assert matrix.shape == (100, 100)
+    rows = np.asarray(matrix.sum(axis=1)).ravel()
+    assert np.count_nonzero(rows) == 25  # boxes with seeds, of which none are lost
+    assert np.allclose(rows[rows > 0], 1)
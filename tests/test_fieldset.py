@@ -1,5 +1,9 @@
 from parcels import FieldSet, ParticleSet, ScipyParticle, JITParticle, Variable, AdvectionRK4, AdvectionRK4_3D, RectilinearZGrid, ErrorCode, OutOfTimeError
-from parcels.field import Field, VectorField
+from parcels import memory_report, print_memory_report, SharedMemoryRing, StateCode
+from parcels.field import Field, VectorField, ChunkedFieldData
+from parcels.fieldfilebuffer import SharedMemoryFileBuffer
+from parcels.tools import chunkcompression
+from parcels.tools.loggers import dup_filter
 from parcels.tools.converters import TimeConverter, _get_cftime_calendars, _get_cftime_datetimes, UnitConverter, GeographicPolar
 import dask.array as da
 import dask
@@ -14,6 +18,7 @@ import gc
 import psutil
 import os
 import sys
+import threading
 
 
 ptype = {'scipy': ScipyParticle, 'jit': JITParticle}
@@ -410,6 +415,226 @@ def test_fieldset_celledgesizes_curvilinear(dx, dy):
     assert np.allclose(A, fieldset.dx.data * fieldset.dy.data)
 
 
+@pytest.mark.parametrize('dx, dy, lon, lat', [('e1u', 'e2u', 'glamu', 'gphiu'), ('e1t', 'e2t', 'glamt', 'gphit')])
+def test_fieldset_celledgesizes_curvilinear_computed(dx, dy, lon, lat):
+    fname = path.join(path.dirname(__file__), 'test_data', 'mask_nemo_cross_180lon.nc')
+    filenames = {'dx': fname, 'dy': fname, 'mesh_mask': fname}
+    variables = {'dx': dx, 'dy': dy}
+    dimensions = {'lon': lon, 'lat': lat}
+    fieldset = FieldSet.from_nemo(filenames, variables, dimensions)
+
+    fieldset.dx.calc_cell_edge_sizes()
+    # the grid crosses the dateline, so the great-circle distances need the longitudes to be wrapped
+    assert np.allclose(fieldset.dx.cell_edge_sizes['x'], fieldset.dx.data[0], rtol=5e-3)
+    assert np.allclose(fieldset.dx.cell_edge_sizes['y'], fieldset.dy.data[0], rtol=5e-3)
+    assert fieldset.dy.grid.cell_edge_sizes is fieldset.dx.grid.cell_edge_sizes
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('mesh', ['flat', 'spherical'])
+def test_fieldset_distance_to_land(mode, mesh):
+    lon = np.arange(10, dtype=np.float32)
+    lat = np.arange(5, dtype=np.float32)
+    U = np.ones((lat.size, lon.size), dtype=np.float32)
+    U[:, 7:] = 0  # land in the east
+    fieldset = FieldSet.from_data({'U': U, 'V': U}, {'lon': lon, 'lat': lat}, mesh=mesh)
+    fieldset.add_distance_to_land()
+
+    dist = np.where(lon < 7, 7 - lon, 6 - lon)
+    if mesh == 'spherical':
+        dist = dist * 1852 * 60 * np.cos(np.radians(lat))[:, None]
+    assert np.allclose(fieldset.distance_to_land.data[0], dist, rtol=1e-3)
+    assert np.allclose(fieldset.ocean_direction_x.data, -1, atol=1e-3)  # seaward is westward everywhere
+    assert np.allclose(fieldset.ocean_direction_y.data, 0, atol=1e-2)
+
+    # the curvilinear path gives the same result
+    lon2d, lat2d = np.meshgrid(lon, lat)
+    fieldset2 = FieldSet.from_data({'U': U, 'V': U}, {'lon': lon2d, 'lat': lat2d}, mesh=mesh)
+    fieldset2.add_distance_to_land(name='coast', direction_names=None)
+    assert np.allclose(fieldset2.coast.data, fieldset.distance_to_land.data)
+
+    class CoastParticle(ptype[mode]):
+        d = Variable('d', dtype=np.float32)
+
+    def SampleCoast(particle, fieldset, time):
+        particle.d = fieldset.distance_to_land[time, particle.depth, particle.lat, particle.lon]
+
+    pset = ParticleSet(fieldset, pclass=CoastParticle, lon=[2.5, 6.5], lat=[0, 0])
+    pset.execute(SampleCoast, runtime=1, dt=1)
+    scale = 1852 * 60 if mesh == 'spherical' else 1
+    assert np.allclose(pset.d, np.array([4.5, 0]) * scale, rtol=1e-3)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+def test_fieldset_memory_report(mode, tmpdir, capsys, npart=10, xdim=40, ydim=20):
+    data, dimensions = generate_fieldset(xdim, ydim)
+    data = {'U': data['U'] * 1e-3, 'V': data['V'] * 0}
+    fieldset = FieldSet.from_data(data, dimensions, mesh='flat')
+    fieldset.add_periodic_halo(zonal=True, halosize=2)
+    pset = ParticleSet(fieldset, pclass=ptype[mode], lon=np.linspace(1, 9, npart), lat=np.full(npart, 5))
+    output_file = pset.ParticleFile(name=tmpdir.join("memory_report.nc"), outputdt=1)
+    pset.execute(AdvectionRK4, runtime=2, dt=1, output_file=output_file)
+
+    report = memory_report(pset, output_file=output_file)
+    u = report['fields']['U']
+    assert u['data_bytes'] == (xdim + 4) * ydim * 4 and u['time_slices'] == 1
+    assert u['chunk_bytes'] == (u['data_bytes'] if mode == 'jit' else 0)  # chunks are copies of the data
+    assert np.isclose(u['halo_bytes'], u['bytes'] * 4. / (xdim + 4), atol=1)
+    assert report['grids'][0]['fields'] == ['U', 'V']
+    assert report['grids'][0]['chunks']['loaded_touched'] == (1 if mode == 'jit' else 0)
+    assert report['particles']['lon'] == npart * 4
+    assert report['output']['staged_files'] == 3 and report['output']['staged_bytes_on_disk'] > 0
+    assert report['accounted'] >= u['bytes'] + sum(report['particles'].values())
+    assert report['accounted_high_water'] >= report['accounted']
+    assert report['rss_high_water'] >= report['rss'] > 0
+    output_file.close()
+
+    print_memory_report(report)
+    assert 'field U' in capsys.readouterr().out
+
+
+def test_fieldset_scipy_chunked(tmpdir, filename='test_parcels_scipy_chunked', npart=5):
+    filepath = tmpdir.join(filename)
+    data0, dims0 = generate_fieldset(20, 20, 1, 3)
+    data0['U'] = np.random.rand(3, 1, 20, 20).astype(np.float32)
+    dims0['time'] = np.arange(0, 3) * 3600.
+    FieldSet.from_data(data0, dims0, mesh='flat').write(filepath)
+
+    def SampleU(particle, fieldset, time):
+        particle.u = fieldset.U[time, particle.depth, particle.lat, particle.lon]
+
+    samples = {}
+    for mode in ['scipy', 'jit']:
+        fieldset = FieldSet.from_parcels(filepath, chunksize={'time': ('time_counter', 1), 'lat': ('y', 4), 'lon': ('x', 4)})
+
+        class SampleParticle(ptype[mode]):
+            u = Variable('u', dtype=np.float32)
+
+        pset = ParticleSet(fieldset, pclass=SampleParticle, lon=np.linspace(0.1, 0.2, npart), lat=np.linspace(0.1, 0.2, npart))
+        pset.execute(SampleU, runtime=5400, dt=1800)
+        samples[mode] = pset.u
+        if mode == 'scipy':
+            g = fieldset.U.grid
+            assert isinstance(fieldset.U.data, da.core.Array)  # data is not materialised in scipy mode
+            assert any(chunk is None for chunk in fieldset.U.data_chunks)
+            assert np.sum(g.load_chunk == g.chunk_loaded_touched) == len([c for c in fieldset.U.data_chunks if c is not None])
+    assert np.allclose(samples['scipy'], samples['jit'])
+
+
+def test_fieldset_out_of_core_execution(tmpdir, filename='test_parcels_out_of_core', npart=20):
+    filepath = tmpdir.join(filename)
+    data0, dims0 = generate_fieldset(40, 40, 1, 3)
+    data0['U'] = np.ones((3, 1, 40, 40), dtype=np.float32) * 5e-4
+    data0['V'] = np.zeros((3, 1, 40, 40), dtype=np.float32)
+    dims0['time'] = np.arange(0, 3) * 3600.
+    FieldSet.from_data(data0, dims0, mesh='flat').write(filepath)
+
+    lons = {}
+    lon0 = np.tile(np.linspace(0.5, 2.5, npart // 2), 2)
+    block_bytes = 2 * 2 * 10 * 10 * 4  # U and V, two time steps, 10x10 cells
+    for memory_budget in [None, 2 * block_bytes]:
+        fieldset = FieldSet.from_parcels(filepath, chunksize={'time': ('time_counter', 1), 'lat': ('y', 10), 'lon': ('x', 10)})
+        pset = ParticleSet(fieldset, pclass=JITParticle, lon=lon0, lat=np.repeat([0.5, 9.5], npart // 2))
+        kernel = pset.Kernel(AdvectionRK4, memory_budget=memory_budget)
+        pset.execute(kernel, runtime=7200, dt=600)
+        lons[memory_budget] = pset.lon
+        g = fieldset.U.grid
+        nloaded = np.sum(np.isin(g.load_chunk, g.chunk_loaded))
+        if memory_budget is None:
+            assert nloaded > 2
+        else:
+            assert kernel.scheduler.rounds > 1
+            assert nloaded <= 2 and len([c for c in fieldset.U.data_chunks if c is not None]) <= 2
+    assert np.allclose(lons[None], lons[2 * block_bytes])
+    assert np.allclose(lons[None], lon0 + 3.6)
+
+
+def test_fieldset_out_of_core_execution_error(tmpdir, filename='test_parcels_out_of_core_error', npart=20):
+    filepath = tmpdir.join(filename)
+    data0, dims0 = generate_fieldset(40, 40, 1, 3)
+    dims0['time'] = np.arange(0, 3) * 3600.
+    FieldSet.from_data(data0, dims0, mesh='flat').write(filepath)
+    fieldset = FieldSet.from_parcels(filepath, chunksize={'time': ('time_counter', 1), 'lat': ('y', 10), 'lon': ('x', 10)})
+    pset = ParticleSet(fieldset, pclass=JITParticle, lon=np.tile(np.linspace(0.5, 2.5, npart // 2), 2),
+                       lat=np.repeat([0.5, 9.5], npart // 2))
+    kernel = pset.Kernel(AdvectionRK4, memory_budget=2 * 2 * 10 * 10 * 4)
+
+    def failing_execute_jit(pset, endtime, dt):
+        raise RuntimeError('kernel failed')
+
+    kernel.execute_jit = failing_execute_jit
+    with pytest.raises(RuntimeError):
+        pset.execute(kernel, runtime=7200, dt=600)
+    assert np.all(pset.collection.state == StateCode.Evaluate)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('codec, keepbits', [('lz4', None), ('zlib', None), ('zstd', 10)])
+def test_fieldset_chunk_compression(mode, codec, keepbits, tmpdir, filename='test_parcels_chunk_compression'):
+    filepath = tmpdir.join(filename)
+    data0, dims0 = generate_fieldset(40, 40, 1, 3)
+    data0['U'] = np.ones((3, 1, 40, 40), dtype=np.float32) * 2e-3
+    data0['V'] = np.zeros((3, 1, 40, 40), dtype=np.float32)
+    dims0['time'] = np.arange(0, 3) * 3600.
+    FieldSet.from_data(data0, dims0, mesh='flat').write(filepath)
+
+    lons = {}
+    for compress in [False, True]:
+        fieldset = FieldSet.from_parcels(filepath, chunksize={'time': ('time_counter', 1), 'lat': ('y', 10), 'lon': ('x', 10)})
+        decompressed = []
+        compressed_bytes = []
+        if compress:
+            fieldset.set_chunk_compression(codec, keepbits=keepbits)
+            compressor = fieldset.U.chunk_compressor
+            decompress = compressor.decompress
+            compressor.decompress = lambda c: decompressed.append(c.nbytes) or decompress(c)
+
+        def log_compressed():
+            compressed_bytes.append(memory_report(fieldset=fieldset)['fields']['U']['compressed_bytes'])
+        # the second particle follows the first one through the blocks that it left, after they have gone cold
+        pset = ParticleSet(fieldset, pclass=ptype[mode], lon=[0.5, 0.5], lat=[5., 5.], time=[0., 2400.])
+        pset.execute(AdvectionRK4, runtime=3600, dt=300, postIterationCallbacks=[log_compressed], callbackdt=600)
+        lons[compress] = pset.lon
+        if compress:
+            assert max(compressed_bytes) > 0
+            assert len(decompressed) > 0
+            if keepbits is None:
+                assert max(compressed_bytes) < 0.25 * 2 * 10 * 10 * 4  # a block of constant U is very compressible
+        else:
+            assert max(compressed_bytes) == 0
+    assert np.allclose(lons[False], [7.7, 2.9], atol=1e-4)
+    assert np.allclose(lons[True], lons[False], atol=0 if keepbits is None else 1e-2)
+
+
+def test_fieldset_chunk_compression_fallback(monkeypatch, caplog):
+    monkeypatch.setattr(chunkcompression, 'Blosc', None)  # as if numcodecs is not installed
+    monkeypatch.setattr(dup_filter, 'msgs', set())
+    compressor = chunkcompression.ChunkCompressor('zstd')
+    assert compressor.name == 'zlib'
+    assert "falling back to zlib" in caplog.text
+    block = np.random.rand(2, 10, 10).astype(np.float32)
+    assert np.array_equal(compressor.decompress(compressor.compress(block)), block)
+
+
+def test_fieldset_scipy_chunked_indexing(tmpdir, filename='test_parcels_scipy_chunked_indexing'):
+    filepath = tmpdir.join(filename)
+    data0, dims0 = generate_fieldset(20, 20, 1, 3)
+    data0['U'] = np.random.rand(3, 1, 20, 20).astype(np.float32)
+    dims0['time'] = np.arange(0, 3) * 3600.
+    FieldSet.from_data(data0, dims0, mesh='flat').write(filepath)
+    fieldset = FieldSet.from_parcels(filepath, chunksize={'time': ('time_counter', 1), 'lat': ('y', 4), 'lon': ('x', 4)})
+    fieldset.computeTimeChunk(0, 1)
+    data = fieldset.U.interpolation_data
+    U = np.asarray(fieldset.U.data)
+    assert isinstance(data, ChunkedFieldData) and data.shape == U.shape == (2, 20, 20)
+    assert np.allclose(data[1, 3:9, 2:7], U[1, 3:9, 2:7])
+    assert np.allclose(data[1][-1, 5:15], U[1, -1, 5:15])
+    assert data[-1, 19, 19] == U[-1, 19, 19]
+    for key in [(2, 0, 0), (0, 20, 0), (0, 0, -21), (0, 0, 0, 0)]:
+        with pytest.raises(IndexError):
+            data[key]
+
+
 def test_fieldset_write_curvilinear(tmpdir):
     fname = path.join(path.dirname(__file__), 'test_data', 'mask_nemo_cross_180lon.nc')
     filenames = {'dx': fname, 'mesh_mask': fname}
@@ -610,6 +835,42 @@ def test_from_netcdf_chunking(mode, time_periodic, chunksize, deferLoad):
     pset.execute(AdvectionRK4, dt=1, runtime=1)
 
 
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('indices', [None, {'lon': range(8, 72)}])
+def test_from_zarr_native_chunks(mode, indices, tmpdir):
+    pytest.importorskip('zarr')
+    xdim, ydim, tdim = 80, 60, 4
+    lon = np.linspace(0, 7.9, xdim)
+    lat = np.linspace(0, 5.9, ydim)
+    time = np.arange(tdim) * 3600.
+    U = 1e-4 + 1e-8 * np.arange(ydim * xdim).reshape(1, ydim, xdim) * np.ones((tdim, 1, 1))
+    V = 5e-5 * np.ones((tdim, ydim, xdim))
+    ds = xr.Dataset({'U': (('time', 'y', 'x'), U.astype(np.float32)), 'V': (('time', 'y', 'x'), V.astype(np.float32))},
+                    coords={'lon': ('x', lon), 'lat': ('y', lat), 'time': time})
+    store = str(tmpdir.join('test_native_chunks.zarr'))
+    ds.to_zarr(store, encoding={v: {'chunks': (1, 16, 32)} for v in ['U', 'V']})
+
+    variables = {'U': 'U', 'V': 'V'}
+    dimensions = {'lon': 'lon', 'lat': 'lat', 'time': 'time'}
+    fieldsets = [FieldSet.from_netcdf(store, variables, dimensions, indices=indices, mesh='flat',
+                                      netcdf_engine='zarr', chunksize=chunksize) for chunksize in ['native', False]]
+    lonp = np.linspace(2, 5, 10)
+    latp = np.linspace(1, 4, 10)
+    psets = [ParticleSet(fieldset=fs, pclass=ptype[mode], lon=lonp, lat=latp) for fs in fieldsets]
+    for pset in psets:
+        pset.execute(AdvectionRK4, runtime=2*3600, dt=600)
+    assert np.allclose(psets[0].lon, psets[1].lon) and np.allclose(psets[0].lat, psets[1].lat)
+
+    # the blocks are the chunks of the store, cut only at the edges of the subset
+    U = fieldsets[0].U
+    assert U.data.chunks[0] == (1, 1)
+    assert U.data.chunks[1:] == ((16, 16, 16, 12), (32, 32, 16) if indices is None else (24, 32, 8))
+    assert fieldsets[0].U.grid is not fieldsets[0].V.grid
+    if mode == 'jit':
+        assert U.grid.chunk_info == [2, 4, 3, 16, 16, 16, 12] + list(U.data.chunks[2])
+        assert np.sum(U.grid.load_chunk > 0) < len(U.grid.load_chunk)  # particles only touch some of the blocks
+
+
 @pytest.mark.parametrize('datetype', ['float', 'datetime64'])
 def test_timestamps(datetype, tmpdir):
     data1, dims1 = generate_fieldset(10, 10, 1, 10)
@@ -935,3 +1196,158 @@ def test_deferredload_simplefield(mode, direction, time_extrapolation, tmpdir, t
     runtime = tdim*2 if time_extrapolation else None
     pset.execute(SampleU, dt=direction, runtime=runtime)
     assert pset.p == tdim-1 if time_extrapolation else tdim-2
+
+
+@pytest.mark.parametrize('numa_policy', [None, 'firsttouch', 'interleave', 'local'])
+def test_fieldset_numa_policy(numa_policy):
+    import mmap
+    from parcels.tools.allocation import set_numa_policy, get_numa_policy, is_placed
+    data, dimensions = generate_fieldset(20, 20)
+    lons, lats = {}, {}
+    try:
+        for policy in [None, numa_policy]:
+            set_numa_policy(policy)
+            if policy is None:
+                assert get_numa_policy() is None
+            else:  # without libnuma, 'interleave' and 'local' fall back to 'firsttouch'
+                assert get_numa_policy() in [policy, 'firsttouch']
+            fieldset = FieldSet.from_data(data, dimensions, mesh='flat')
+            pset = ParticleSet(fieldset, JITParticle, lon=[2, 4], lat=[3, 5])
+            pset.execute(AdvectionRK4, runtime=0.1, dt=0.01)
+            for arr in [fieldset.U.data_chunks[0], pset._collection.data['lon']]:
+                assert is_placed(arr)
+                base = arr
+                while isinstance(base, np.ndarray) and base.base is not None:
+                    base = base.base
+                base = base.obj if isinstance(base, memoryview) else base
+                assert isinstance(base, mmap.mmap) == (policy is not None)
+            lons[policy], lats[policy] = pset.lon, pset.lat
+    finally:
+        set_numa_policy(None)
+    assert np.allclose(lons[None], lons[numa_policy])
+    assert np.allclose(lats[None], lats[numa_policy])
+
+
+@pytest.mark.parametrize('hugepage_policy', ['thp', 'hugetlb'])
+def test_fieldset_hugepage_policy(hugepage_policy):
+    from parcels.tools.allocation import set_hugepage_policy
+    data, dimensions = generate_fieldset(1000, 1000)
+    try:
+        set_hugepage_policy(hugepage_policy)
+        fieldset = FieldSet.from_data(data, dimensions, mesh='flat')
+        pset = ParticleSet(fieldset, JITParticle, lon=[2, 4], lat=[3, 5])
+        pset.execute(AdvectionRK4, runtime=0.1, dt=0.01)
+        assert fieldset.U.data_chunks[0].ctypes.data % (2*1024*1024) == 0
+    finally:
+        set_hugepage_policy(None)
+    assert np.allclose(fieldset.U.data_chunks[0], fieldset.U.data)
+
+
+@pytest.mark.parametrize('chunksize', [False, {'time': ('time_counter', 1), 'lat': ('y', 64), 'lon': ('x', 128)}])
+@pytest.mark.parametrize('keepbits', [None, 10])
+def test_fieldset_ingest(chunksize, keepbits, tmpdir, filename='test_parcels_ingest'):
+    filepath = tmpdir.join(filename)
+    data, dims = generate_fieldset(400, 300, 1, 4)
+    dims['time'] = np.arange(4) * 3600.
+    data['U'] = np.random.RandomState(1).uniform(-3, 3, data['U'].shape).astype(np.float32)
+    data['U'][:, :, 10:20, 30:50] = np.nan
+    FieldSet.from_data(data, dims).write(filepath)
+
+    fieldset = FieldSet.from_parcels(filepath, chunksize=chunksize, vmin=-2.5, vmax=2.)
+    fieldset.U.set_scaling_factor(0.5)
+    fieldset.U.set_keepbits(keepbits)
+    pset = ParticleSet(fieldset, JITParticle, lon=[2, 4], lat=[3, 5])
+    pset.execute(AdvectionRK4, runtime=3600, dt=600)
+
+    tind = (fieldset.U.grid.time / 3600).astype(int)
+    expected = np.nan_to_num(data['U'][tind, 0]) * 0.5
+    expected[(expected < -2.5) | (expected > 2.)] = 0
+    loaded = np.array(fieldset.U.data)
+    assert not np.isnan(loaded).any()
+    assert np.allclose(loaded, expected, rtol=2.**-keepbits if keepbits else 1e-7, atol=0)
+    if keepbits:
+        assert np.all(loaded.view(np.uint32) & np.uint32((1 << (23 - keepbits)) - 1) == 0)
+
+
+def test_fieldset_keepbits_source_intact():
+    from concurrent.futures import ThreadPoolExecutor
+    from parcels.tools import ingest as ingest_module
+    data, dims = generate_fieldset(400, 300)
+    data['U'] = np.random.RandomState(1).uniform(-3, 3, data['U'].shape).astype(np.float32)
+    source = data['U'].copy()
+    fieldset = FieldSet.from_data(data, dims, transpose=False)
+    fieldset.U.set_keepbits(10)
+    assert np.array_equal(data['U'], source)
+    assert not np.array_equal(fieldset.U.data, source)
+
+    ingest_module._ingest_pool = None
+    with ThreadPoolExecutor(max_workers=8) as pool:
+        pools = list(pool.map(lambda _: ingest_module._ingest_threads(), range(8)))
+    assert all(p is pools[0] for p in pools)
+
+
+@pytest.mark.skipif(sys.version_info < (3, 8), reason="multiprocessing.shared_memory requires Python >= 3.8")
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('nslots', [2, 3])
+def test_fieldset_from_shared_memory(mode, nslots):
+    lon = np.linspace(0, 1e5, 21, dtype=np.float32)
+    lat = np.linspace(0, 1e5, 11, dtype=np.float32)
+    times = np.arange(11) * 100.
+    name = 'parcels_test_ring_%d_%s_%d' % (os.getpid(), mode, nslots)
+    ring = SharedMemoryRing.create(name, ['U', 'V'], lon, lat, times, nslots=nslots, mesh='flat')
+
+    def produce():  # stand-in for a running model, which publishes one time slice per model step
+        for t in times:
+            ring.publish({'U': np.full((11, 21), 1. + t / 1000., dtype=np.float32),
+                          'V': np.full((11, 21), np.nan if t == 0 else 0.5, dtype=np.float32)}, timeout=30)
+
+    producer = threading.Thread(target=produce)
+    producer.start()
+    fieldset = FieldSet.from_shared_memory(name, timeout=30)
+    pset = ParticleSet(fieldset, pclass=ptype[mode], lon=[1000, 2000], lat=[1000, 1000])
+    pset.execute(AdvectionRK4, runtime=1000, dt=10)
+    producer.join()
+
+    # U = 1 + t/1000, so that x = x0 + t + t^2/2000; V is NaN (so zero) at t=0 and 0.5 from t=100
+    assert np.allclose(pset.lon, [2500, 3500], rtol=1e-5)
+    assert np.allclose(pset.lat, 1000 + 0.5 * 1000 - 0.5 * 100 / 2, rtol=1e-5)
+    assert not fieldset.U.data.flags.owndata
+    if mode == 'jit':
+        assert fieldset.U.data_chunks[0] is fieldset.U.data
+    with pytest.raises(RuntimeError):
+        ring.publish({'U': np.zeros((11, 21)), 'V': np.zeros((11, 21))})
+    ring.close()
+
+
+@pytest.mark.skipif(sys.version_info < (3, 8), reason="multiprocessing.shared_memory requires Python >= 3.8")
+def test_fieldset_from_shared_memory_timeout():
+    name = 'parcels_test_ring_timeout_%d' % os.getpid()
+    ring = SharedMemoryRing.create(name, ['U', 'V'], [0, 1], [0, 1], [0., 1., 2.], nslots=2, mesh='flat')
+    ring.publish({'U': np.zeros((2, 2)), 'V': np.zeros((2, 2))})
+    fieldset = FieldSet.from_shared_memory(name, timeout=0.1)
+    with pytest.raises(TimeoutError):
+        fieldset.computeTimeChunk(0, 1)
+    ring.close()
+
+
+@pytest.mark.skipif(sys.version_info < (3, 8), reason="multiprocessing.shared_memory requires Python >= 3.8")
+def test_fieldset_from_shared_memory_close(monkeypatch):
+    name = 'parcels_test_ring_close_%d' % os.getpid()
+    ring = SharedMemoryRing.create(name, ['U', 'V'], [0, 1], [0, 1], [0., 1., 2.], nslots=2, mesh='flat')
+    fieldset = FieldSet.from_shared_memory(name)
+    filebuffer = fieldset.U.filebuffers[0]
+    assert filebuffer.ring is not None
+    fieldset.close()
+    assert filebuffer.ring is None and fieldset.U.filebuffers[0] is None
+
+    filebuffer = FieldSet.from_shared_memory(name).V.filebuffers[0]
+    gc.collect()
+    assert filebuffer.ring is None  # closed when the FieldSet is released
+
+    closed = []
+    close = SharedMemoryFileBuffer.close
+    monkeypatch.setattr(SharedMemoryFileBuffer, 'close', lambda self: closed.append(self.filename) or close(self))
+    with pytest.raises(IOError):
+        FieldSet.from_shared_memory(name, variables={'U': 'U', 'V': 'W'})
+    assert len(closed) == 2  # the buffer of V that failed, and the buffer of U that was already created
+    ring.close()
@@ -1,6 +1,7 @@
 from parcels import (FieldSet, Field, NestedField, ParticleSet, ScipyParticle, JITParticle, Geographic,
-                     AdvectionRK4, AdvectionRK4_3D, Variable, ErrorCode)
+                     AdvectionRK4, AdvectionRK4_3D, Variable, ColumnVariable, ErrorCode)
 import numpy as np
+import dask.array as da
 import pytest
 from math import cos, pi
 from datetime import timedelta as delta
@@ -467,6 +468,71 @@ def test_sampling_out_of_bounds_time(mode, allow_time_extrapolation, k_sample_p,
             pset.execute(k_sample_p, runtime=0.1, dt=0.1)
 
 
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('chunked', [False, True])
+@pytest.mark.parametrize('zdim', [1, 4])
+def test_sampling_static_field(mode, chunked, zdim, k_sample_p, xdim=20, ydim=10, tdim=3):
+    lon = np.linspace(0., 1., xdim, dtype=np.float32)
+    lat = np.linspace(0., 1., ydim, dtype=np.float32)
+    depth = np.linspace(0., 1., zdim, dtype=np.float32)
+    time = np.linspace(0., 10., tdim, dtype=np.float64)
+    fieldset = FieldSet.from_data({'U': np.zeros((tdim, ydim, xdim), dtype=np.float32),
+                                   'V': np.zeros((tdim, ydim, xdim), dtype=np.float32)},
+                                  {'lon': lon, 'lat': lat, 'time': time}, mesh='flat')
+    P = (lon[None, None, :] + 2 * lat[None, :, None] + 4 * depth[:, None, None]).astype(np.float32)
+    if chunked:
+        P = da.from_array(P, chunks=(zdim, 5, 5))
+    fieldset.add_field(Field('P', P if zdim > 1 else P[0], lon=lon, lat=lat, depth=depth if zdim > 1 else None, mesh='flat'))
+    assert fieldset.P.static and fieldset.P.dense != chunked and not fieldset.U.static
+
+    plon, plat, pdepth = np.linspace(0.05, 0.95, 10), np.linspace(0.1, 0.9, 10), np.linspace(0., 1., 10)
+    pset = ParticleSet(fieldset, pclass=pclass(mode), lon=plon, lat=plat, depth=pdepth if zdim > 1 else None, time=2.)
+    if mode == 'jit':
+        kernel = pset.Kernel(k_sample_p)
+        assert 'static_interpolation(' in kernel.ccode and 'temporal_interpolation(' not in kernel.ccode
+    pset.execute(k_sample_p, runtime=6, dt=2)
+    assert np.allclose(pset.p, plon + 2 * plat + (4 * pdepth if zdim > 1 else 0), rtol=1e-5)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('zgrid', [True, False])
+@pytest.mark.parametrize('depths', [None, [5., 20., 45., 90.]])
+def test_sample_column(mode, zgrid, depths, xdim=11, ydim=6):
+    lon = np.linspace(0., 1., xdim, dtype=np.float32)
+    lat = np.linspace(0., 1., ydim, dtype=np.float32)
+    levels = np.array([0., 10., 30., 60., 100.], dtype=np.float32)
+    time = np.array([0., 10.])
+    fieldset = FieldSet.from_data({'U': np.zeros((ydim, xdim), dtype=np.float32),
+                                   'V': np.zeros((ydim, xdim), dtype=np.float32)},
+                                  {'lon': lon, 'lat': lat}, mesh='flat')
+    if zgrid:
+        depth = levels
+        depth3D = np.tile(levels[:, None, None], (1, ydim, xdim))
+    else:  # S-grid, with the levels stretched towards the east
+        depth = depth3D = (levels[:, None, None] * (1 + 0.5 * lon[None, None, :]) * np.ones((1, ydim, 1))).astype(np.float32)
+    # linear in lon, depth and time, so that its interpolation is exact
+    T = np.stack([lon[None, None, :] + depth3D + t for t in time]).astype(np.float32)
+    fieldset.add_field(Field('T', T, lon=lon, lat=lat, depth=depth, time=time, mesh='flat'))
+
+    class ProfileParticle(ptype[mode]):
+        temp = ColumnVariable('temp', depths=depths, size=None if depths else len(levels))
+
+    def SampleColumn(particle, fieldset, time):
+        fieldset.T.sample_column(time, particle, 'temp')
+
+    plon = np.array([0.25, 0.62])
+    pset = ParticleSet(fieldset, pclass=ProfileParticle, lon=plon, lat=[0.5, 0.3], time=0)
+    if mode == 'jit':
+        assert 'column_interpolation(' in pset.Kernel(SampleColumn).ccode
+    pset.execute(SampleColumn, runtime=10, dt=5)  # last sampled at time 5
+    assert pset.temp.shape == (2, 4 if depths else len(levels))
+    if depths is None:
+        expected = plon[:, None] + levels[None, :] * (1 if zgrid else 1 + 0.5 * plon[:, None]) + 5
+    else:
+        expected = plon[:, None] + np.array(depths)[None, :] + 5
+    assert np.allclose(pset.temp, expected, rtol=1e-5)
+
+
 @pytest.mark.parametrize('mode', ['jit', 'scipy'])
 @pytest.mark.parametrize('npart', [1, 10])
 @pytest.mark.parametrize('chs', [False, 'auto', {'lat': ('y', 10), 'lon': ('x', 10)}])
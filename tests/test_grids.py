@@ -125,6 +125,69 @@ def test_avoid_repeated_grids():
     assert field_set.V.grid is not field_set.U.grid
 
 
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+def test_shared_horizontal_grids(mode):
+    lon = np.linspace(0, 10, 11, dtype=np.float32)
+    lat = np.linspace(0, 5, 6, dtype=np.float32)
+    depth_t = np.array([0, 10, 20], dtype=np.float32)
+    depth_w = np.array([5, 15, 25], dtype=np.float32)
+
+    def linear_func(lon, lat, depth):
+        return lon + 10 * lat + 100 * depth
+
+    fields = {}
+    for name, depth in [('U', depth_t), ('V', depth_w), ('S', None)]:
+        grid = RectilinearZGrid(lon, lat, depth=depth, mesh='flat')
+        zs = [0] if depth is None else depth
+        data = np.array([[[linear_func(x, y, z if depth is not None else 0) for x in lon] for y in lat] for z in zs], dtype=np.float32)
+        fields[name] = Field(name, data if depth is not None else data[0], grid=grid)
+    field_set = FieldSet(fields['U'], fields['V'], fields={'S': fields['S']})
+    assert field_set.gridset.size == 3
+    assert len(field_set.gridset.hgrids) == 1
+    assert field_set.V.grid.hgrid is field_set.U.grid
+    assert field_set.S.grid.hgrid is field_set.U.grid
+
+    class SampleParticle(ptype[mode]):
+        t = Variable('t', dtype=np.float32)
+        w = Variable('w', dtype=np.float32)
+        s = Variable('s', dtype=np.float32)
+
+    def SampleMove(particle, fieldset, time):
+        particle.t = fieldset.U[time, particle.depth, particle.lat, particle.lon]
+        particle.w = fieldset.V[time, particle.depth, particle.lat, particle.lon]
+        particle.s = fieldset.S[time, particle.depth, particle.lat, particle.lon]
+        particle.lon += 0.37
+
+    lonp = np.array([0.5, 2.25, 4.1])
+    latp = np.array([0.3, 2.7, 4.9])
+    depthp = np.array([6., 12.5, 19.])
+    pset = ParticleSet(field_set, pclass=SampleParticle, lon=lonp, lat=latp, depth=depthp)
+    pset.execute(SampleMove, runtime=3, dt=1)
+    lon_sampled = lonp + 0.37 * 2
+    assert np.allclose(pset.t, linear_func(lon_sampled, latp, depthp), rtol=1e-5)
+    assert np.allclose(pset.w, linear_func(lon_sampled, latp, depthp), rtol=1e-5)
+    assert np.allclose(pset.s, linear_func(lon_sampled, latp, 0), rtol=1e-5)
+
+
+def test_shared_horizontal_grids_exact():
+    lon = np.linspace(170, 180, 11, dtype=np.float32)
+    lat = np.linspace(0, 5, 6, dtype=np.float32)
+    grid = RectilinearZGrid(lon, lat, mesh='spherical')
+    assert grid.same_horizontal_mesh(RectilinearZGrid(lon.copy(), lat.copy(), mesh='spherical'))
+    # within the default rtol of np.allclose, but a different mesh
+    assert not grid.same_horizontal_mesh(RectilinearZGrid(lon + 1e-3, lat, mesh='spherical'))
+    assert not grid.same_horizontal_mesh(RectilinearZGrid(lon, lat, mesh='flat'))
+    periodic = RectilinearZGrid(lon, lat, mesh='spherical')
+    periodic.zonal_periodic = True
+    assert not grid.same_horizontal_mesh(periodic)
+    lons, lats = np.meshgrid(lon, lat)
+    curvilinear = CurvilinearZGrid(lons, lats, mesh='spherical')
+    coefs = CurvilinearZGrid(lons, lats, mesh='spherical')
+    assert curvilinear.same_horizontal_mesh(coefs)
+    coefs.set_search_coefs()
+    assert not curvilinear.same_horizontal_mesh(coefs)
+
+
 @pytest.mark.parametrize('mode', ['scipy', 'jit'])
 def test_multigrids_pointer(mode):
     lon_g0 = np.linspace(0, 1e4, 21, dtype=np.float32)
@@ -396,6 +459,31 @@ def test_advect_nemo(mode):
     assert abs(pset.lat[0] - latp) < 1e-3
 
 
+def test_advect_nemo_search_coefs():
+    data_path = path.join(path.dirname(__file__), 'test_data/')
+
+    filenames = {'U': {'lon': data_path + 'mask_nemo_cross_180lon.nc',
+                       'lat': data_path + 'mask_nemo_cross_180lon.nc',
+                       'data': data_path + 'Uu_eastward_nemo_cross_180lon.nc'},
+                 'V': {'lon': data_path + 'mask_nemo_cross_180lon.nc',
+                       'lat': data_path + 'mask_nemo_cross_180lon.nc',
+                       'data': data_path + 'Vv_eastward_nemo_cross_180lon.nc'}}
+    variables = {'U': 'U', 'V': 'V'}
+    dimensions = {'lon': 'glamf', 'lat': 'gphif'}
+
+    lonp = [174.5, 178.5, 179.8, -179.2, -177.5]
+    latp = [81.5, 81.2, 81.4, 81.1, 81.3]
+    lons = {}
+    for use_search_coefs in [False, True]:
+        field_set = FieldSet.from_nemo(filenames, variables, dimensions)
+        field_set.U.grid.set_search_coefs(use_search_coefs)
+        pset = ParticleSet.from_list(field_set, JITParticle, lon=lonp, lat=latp)
+        pset.execute(AdvectionRK4, runtime=delta(hours=12), dt=delta(hours=3))
+        lons[use_search_coefs] = pset.lon
+        assert (field_set.U.grid.search_coefs is not None) == use_search_coefs
+    assert np.allclose(lons[False], lons[True], rtol=1e-5)
+
+
 @pytest.mark.parametrize('mode', ['scipy', 'jit'])
 @pytest.mark.parametrize('time', [True, False])
 def test_cgrid_uniform_2dvel(mode, time):
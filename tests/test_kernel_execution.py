@@ -1,8 +1,10 @@
 from os import path
 from parcels import (
     FieldSet, ParticleSet, ScipyParticle, JITParticle, StateCode, OperationCode, ErrorCode, KernelError,
-    OutOfBoundsError, AdvectionRK4
+    OutOfBoundsError, AdvectionRK4, Variable, start_tracing, stop_tracing, tracer
 )
+from parcels.compilation.codecompiler import InMemoryLibrary, load_libtcc
+import json
 import numpy as np
 import pytest
 import sys
@@ -185,6 +187,95 @@ def test_execution_delete_out_of_bounds(fieldset, mode, npart=10):
     assert len(pset) == 0
 
 
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('policy', ['reflect', 'clamp', 'periodic', 'delete', 'freeze'])
+def test_execution_boundary_policy(fieldset, mode, policy, npart=10):
+    def MoveRight(particle, fieldset, time):
+        fieldset.U[time, particle.depth, particle.lat, particle.lon]
+        particle.lon += 0.3
+
+    lon = np.linspace(0.05, 0.95, npart)
+    fieldset.set_boundary_policy(out_of_bounds=policy)
+    pset = ParticleSet(fieldset, pclass=ptype[mode], lon=lon, lat=np.linspace(1, 0, npart))
+    pset.execute(MoveRight, endtime=10., dt=1.)  # the default recovery kernel would raise an OutOfBoundsError
+    if policy == 'delete':
+        assert len(pset) == 0
+        return
+    assert np.allclose(pset.time, 10.)
+    if policy == 'freeze':
+        # frozen at the start of the time step that left the domain
+        assert np.all((pset.lon > 0.7 - 1e-6) & (pset.lon <= 1))
+        return
+    for _ in range(10):
+        lon += 0.3
+        if policy == 'reflect':
+            lon = np.where(lon > 1, 2 - lon, lon)
+        elif policy == 'clamp':
+            lon = np.minimum(lon, 1)
+        else:
+            lon = np.where(lon > 1, lon - 1, lon)
+    assert np.allclose(pset.lon, lon, atol=1e-5)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('policy, lon_step1, lon_step2', [('reflect', 0.95, 0.95), ('clamp', 1., 1.), ('periodic', 0.05, 0.15)])
+def test_execution_boundary_policy_rk4_stage(mode, policy, lon_step1, lon_step2):
+    lon = np.linspace(0, 1, 11, dtype=np.float32)
+    lat = np.linspace(0, 1, 11, dtype=np.float32)
+    data = {'U': 0.1 * np.ones((11, 11), dtype=np.float32), 'V': np.zeros((11, 11), dtype=np.float32)}
+    fieldset = FieldSet.from_data(data, {'lon': lon, 'lat': lat}, mesh='flat')
+    fieldset.set_boundary_policy(out_of_bounds=policy)
+    pset = ParticleSet(fieldset, pclass=ptype[mode], lon=[0.95], lat=[0.5])
+    # the first step starts inside the domain, but its last RK4 stage samples at lon=1.05, where it ends;
+    # the particle is then moved back into the domain at the end of that step
+    pset.execute(AdvectionRK4, runtime=1., dt=1.)
+    assert np.allclose(pset.lon, lon_step1, atol=1e-6)
+    pset.execute(AdvectionRK4, runtime=1., dt=1.)
+    assert np.allclose(pset.lon, lon_step2, atol=1e-6)
+    assert np.allclose(pset.time, 2.)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('policy', ['reflect', 'clamp', 'delete', 'freeze'])
+def test_execution_boundary_policy_through_surface(mode, policy):
+    def MoveUp(particle, fieldset, time):
+        fieldset.U[time, particle.depth, particle.lat, particle.lon]
+        particle.depth -= 0.3
+
+    lon = np.linspace(0, 1, 5, dtype=np.float32)
+    depth = np.linspace(0, 1, 5, dtype=np.float32)
+    data = {'U': np.zeros((5, 5, 5), dtype=np.float32), 'V': np.zeros((5, 5, 5), dtype=np.float32)}
+    fieldset = FieldSet.from_data(data, {'lon': lon, 'lat': lon, 'depth': depth}, mesh='flat')
+    fieldset.set_boundary_policy(through_surface=policy)
+    pset = ParticleSet(fieldset, pclass=ptype[mode], lon=[0.5], lat=[0.5], depth=[0.5])
+    depths = []
+    for _ in range(3):
+        if len(pset) > 0:
+            pset.execute(MoveUp, runtime=1., dt=1.)
+            depths += list(pset.depth)
+    expected = {'reflect': [0.2, 0.1, 0.2], 'clamp': [0.2, 0, 0], 'delete': [0.2], 'freeze': [0.2, 0.2, 0.2]}[policy]
+    # a particle that crosses the surface is handled in the same step, so it is never written above the surface
+    assert np.allclose(depths, expected, atol=1e-6)
+
+
+def test_execution_boundary_policy_grids():
+    lon, lat = np.meshgrid(np.linspace(0, 1, 11, dtype=np.float32), np.linspace(0, 1, 11, dtype=np.float32))
+    data = {'U': np.ones((11, 11), dtype=np.float32), 'V': np.zeros((11, 11), dtype=np.float32)}
+    fieldset = FieldSet.from_data(data, {'lon': lon, 'lat': lat}, mesh='flat')
+    for policy in ['reflect', 'clamp', 'periodic']:
+        with pytest.raises(NotImplementedError):
+            fieldset.set_boundary_policy(out_of_bounds=policy)
+    assert np.all(fieldset.boundary_policy == 0)
+    fieldset.set_boundary_policy(out_of_bounds='delete', through_surface='freeze')
+    assert list(fieldset.boundary_policy) == [4, 5]
+
+    lon = np.linspace(0, 1, 11, dtype=np.float32)
+    lon[0] = np.nan  # masked coordinates
+    fieldset = FieldSet.from_data(data, {'lon': lon, 'lat': lat[:, 0]}, mesh='flat')
+    with pytest.raises(NotImplementedError):
+        fieldset.set_boundary_policy(through_surface='clamp')
+
+
 @pytest.mark.parametrize('mode', ['scipy', 'jit'])
 def test_kernel_add_no_new_variables(fieldset, mode):
     def MoveEast(particle, fieldset, time):
@@ -284,3 +375,141 @@ def test_execution_keep_cfiles_and_nocompilation_warnings(fieldset, delete_cfile
         assert path.exists(cfile)
         with open(logfile) as f:
             assert 'warning' not in f.read(), 'Compilation WARNING in log file'
+
+
+def test_execution_profile(npart=10):
+    def Age(particle, fieldset, time):
+        particle.age += particle.dt
+
+    def SampleU(particle, fieldset, time):
+        particle.u = fieldset.U[time, particle.depth, particle.lat, particle.lon]
+        if particle.u > 1e6:
+            return StateCode.Success  # an early return still charges the sub-kernel
+        particle.u += 0
+
+    class ProfileParticle(JITParticle):
+        age = Variable('age', dtype=np.float32, initial=0.)
+        u = Variable('u', dtype=np.float32)
+
+    lons = {}
+    for profile in [False, True]:
+        pset = ParticleSet(fieldset(), pclass=ProfileParticle,
+                           lon=np.linspace(0.05, 0.5, npart), lat=np.linspace(0.5, 0.05, npart))
+        kernel = pset.Kernel(AdvectionRK4, profile=profile) + SampleU + pset.Kernel(Age)
+        pset.execute(kernel, endtime=0.5, dt=0.05)
+        lons[profile] = pset.lon
+    assert np.allclose(lons[False], lons[True], rtol=1e-5)
+
+    breakdown = kernel.profile_breakdown()
+    assert list(breakdown.keys()) == ['AdvectionRK4', 'SampleU', 'Age', '(loop)']
+    for name in ['AdvectionRK4', 'SampleU', 'Age']:
+        assert breakdown[name]['calls'] == npart * 10
+        assert breakdown[name]['time'] > 0
+    assert np.isclose(sum(b['fraction'] for b in breakdown.values()), 1)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+def test_execution_trace(mode, tmpdir, npart=10):
+    def MoveRight(particle, fieldset, time):
+        fieldset.U[time, particle.depth, particle.lat, particle.lon + 0.1]
+        particle.lon += 0.1
+
+    def MoveLeft(particle, fieldset, time):
+        particle.lon -= 0.5
+
+    pset = ParticleSet(fieldset(), pclass=ptype[mode], lon=np.linspace(0.05, 0.95, npart), lat=np.linspace(1, 0, npart))
+    output_file = pset.ParticleFile(name=tmpdir.join("trace_output.nc"), outputdt=2.)
+    start_tracing()
+    pset.execute(MoveRight, endtime=5., dt=1., output_file=output_file,
+                 recovery={ErrorCode.ErrorOutOfBounds: MoveLeft})
+    output_file.close()
+    filename = tmpdir.join("trace.json")
+    stop_tracing(filename)
+
+    with open(filename) as f:
+        events = json.load(f)['traceEvents']
+    spans = [e for e in events if e['ph'] == 'X']
+    names = set(e['name'] for e in spans)
+    assert {'ParticleSet.execute', 'recovery', 'write output', 'export output'} <= names
+    assert ('compile' in names and 'execute_jit' in names) if mode == 'jit' else 'execute_python' in names
+    assert all(e['dur'] >= 0 and e['pid'] == 0 for e in spans)
+    assert any(e['ph'] == 'M' and e['name'] == 'thread_name' for e in events)
+    execute = [e for e in spans if e['name'] == 'ParticleSet.execute'][0]
+    for e in spans:
+        if e['name'] in ['execute_jit', 'execute_python', 'recovery']:
+            assert execute['ts'] <= e['ts'] and e['ts'] + e['dur'] <= execute['ts'] + execute['dur']
+
+    nevents = len(tracer.events)
+    pset.execute(DoNothing, runtime=1., dt=1.)
+    assert len(tracer.events) == nevents
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+def test_execution_prepare(mode, npart=10):
+    lons = []
+    for prepare in [False, True]:
+        pset = ParticleSet(fieldset(), pclass=ptype[mode], lon=np.linspace(0.05, 0.5, npart), lat=np.linspace(0.5, 0.05, npart))
+        if prepare:
+            kernel = pset.prepare(AdvectionRK4, dt=0.1)
+            assert pset.kernel is kernel
+            assert (pset._compile_future is not None) == (mode == 'jit')
+        pset.execute(AdvectionRK4, runtime=0.2, dt=0.1)
+        assert pset._compile_future is None
+        if prepare:
+            assert pset.kernel is kernel
+        lons.append(pset.lon)
+    assert np.allclose(lons[0], lons[1])
+
+    pset.prepare(DoNothing, wait=True)
+    assert pset._compile_future is None and (pset.kernel._lib is not None) == (mode == 'jit')
+    pset.execute(DoNothing, runtime=0.2, dt=0.1)
+    assert np.allclose(pset.lon, lons[1])
+
+
+def test_execution_prepare_compile_error(monkeypatch, npart=10):
+    pset = ParticleSet(fieldset(), pclass=JITParticle, lon=np.linspace(0.05, 0.5, npart), lat=np.linspace(0.5, 0.05, npart))
+    compile_kernel = pset._compile_kernel
+    failures = [RuntimeError('compilation failed')] * 2
+
+    def failing_compile():
+        if failures:
+            raise failures.pop()
+        compile_kernel()
+
+    monkeypatch.setattr(pset, '_compile_kernel', failing_compile)
+    pset.prepare(DoNothing)
+    with pytest.raises(RuntimeError):
+        pset.execute(DoNothing, runtime=0.2, dt=0.1)
+    assert pset.kernel is None
+    with pytest.raises(RuntimeError):
+        pset.execute(DoNothing, runtime=0.2, dt=0.1)
+    assert pset.kernel is None
+    pset.execute(DoNothing, runtime=0.2, dt=0.1)
+    assert pset.kernel._lib is not None
+
+
+def test_execution_jit_backend(monkeypatch, npart=10):
+    lons = {}
+    for backend in ['gcc', 'tcc']:
+        monkeypatch.setenv('PARCELS_JIT_BACKEND', backend)
+        pset = ParticleSet(fieldset(), pclass=JITParticle, lon=np.linspace(0.05, 0.5, npart), lat=np.linspace(0.5, 0.05, npart))
+        pset.execute(AdvectionRK4, runtime=0.2, dt=0.1)
+        in_memory = isinstance(pset.kernel._lib, InMemoryLibrary)
+        assert in_memory == (backend == 'tcc' and load_libtcc() is not None)
+        if in_memory:  # otherwise falls back to gcc
+            assert not path.exists(pset.kernel.lib_file)
+            assert pset.kernel._lib._error_func is not None  # the error callback lives as long as the TCC state
+        lons[backend] = pset.lon
+    assert np.allclose(lons['gcc'], lons['tcc'])
+    assert not np.allclose(lons['gcc'], np.linspace(0.05, 0.5, npart))
+
+
+def test_execution_prefetch(npart=10):
+    lons = {}
+    for prefetch_distance in [0, 4]:
+        pset = ParticleSet(fieldset(), pclass=JITParticle,
+                           lon=np.linspace(0.05, 0.5, npart), lat=np.linspace(0.5, 0.05, npart))
+        pset.execute(pset.Kernel(AdvectionRK4, prefetch_distance=prefetch_distance),
+                     endtime=0.5, dt=0.05)
+        lons[prefetch_distance] = pset.lon
+    assert np.allclose(lons[0], lons[4], rtol=1e-5)
@@ -1,4 +1,4 @@
-from parcels import (FieldSet, ScipyParticle, JITParticle, Variable, ErrorCode)
+from parcels import (FieldSet, ScipyParticle, JITParticle, Variable, ErrorCode, AdvectionRK4, ParticleReplay)
 from parcels.particlefile import _set_calendar
 from parcels.tools.converters import _get_cftime_calendars, _get_cftime_datetimes
 from parcels import ParticleSetSOA, ParticleFileSOA, KernelSOA  # noqa
@@ -297,3 +297,52 @@ def test_reset_dt(fieldset, pset_mode, mode, tmpdir):
     pset.execute(pset.Kernel(Update_lon), endtime=0.1, dt=0.02, output_file=ofile)
 
     assert np.allclose(pset.lon, .6)
+
+
+@pytest.mark.parametrize('mode', ['scipy', 'jit'])
+@pytest.mark.parametrize('chunksize', [1, 4, 100])
+def test_replay_sampling(mode, chunksize, tmpdir):
+    filepath = tmpdir.join("pfile_replay.nc")
+    lon = np.linspace(0, 10, 21, dtype=np.float32)
+    lat = np.linspace(0, 10, 11, dtype=np.float32)
+    time = np.array([0., 10., 20.])
+    P = lon[None, None, :] + 2 * lat[None, :, None] + 0.1 * time[:, None, None]
+    data = {'U': 0.1 * np.ones(P.shape, dtype=np.float32), 'V': 0.05 * np.ones(P.shape, dtype=np.float32),
+            'P': np.array(P, dtype=np.float32)}
+    fieldset = FieldSet.from_data(data, {'lon': lon, 'lat': lat, 'time': time}, mesh='flat')
+
+    pset = ParticleSetSOA(fieldset, pclass=ptype[mode], lon=[1, 2, 3], lat=[1, 1, 2], time=[0, 0, 3])
+    pfile = pset.ParticleFile(name=filepath, outputdt=1)
+    pset.execute(AdvectionRK4, runtime=15, dt=0.5, output_file=pfile)
+    pfile.close()
+
+    class SampleParticle(ptype[mode]):
+        p = Variable('p', dtype=np.float32, initial=np.nan)
+        p64 = Variable('p64', dtype=np.float64, initial=np.nan)
+        n = Variable('n', dtype=np.int32, initial=0)
+
+    def SampleP(particle, fieldset, time):
+        particle.p = fieldset.P[time, particle.depth, particle.lat, particle.lon]
+        particle.p64 = particle.p
+        particle.n = 7
+
+    replay = ParticleReplay(fieldset, pclass=SampleParticle, filename=filepath, chunksize=chunksize)
+    fname = replay.execute(SampleP, tmpdir.join("pfile_replay_sampled.nc"))
+
+    ncfile = Dataset(filepath, 'r', 'NETCDF4')
+    ncsampled = Dataset(fname, 'r', 'NETCDF4')
+    assert np.all(ncsampled.variables['trajectory'][:] == ncfile.variables['trajectory'][:])
+    t = np.ma.filled(ncfile.variables['time'][:], np.nan)
+    assert np.array_equal(np.ma.filled(ncsampled.variables['time'][:], np.nan), t, equal_nan=True)
+    truth = ncfile.variables['lon'][:] + 2 * ncfile.variables['lat'][:] + 0.1 * t
+    p = np.ma.filled(ncsampled.variables['p'][:], np.nan)
+    assert np.array_equal(np.isnan(p), np.isnan(t))
+    assert np.allclose(p[~np.isnan(t)], truth[~np.isnan(t)], rtol=1e-5)
+    # each Variable is written with its own dtype
+    assert ncsampled.variables['p'].dtype == np.float32 and ncsampled.variables['p64'].dtype == np.float64
+    assert np.array_equal(np.ma.filled(ncsampled.variables['p64'][:], np.nan), p, equal_nan=True)
+    assert ncsampled.variables['n'].dtype == np.int32
+    n = np.ma.filled(ncsampled.variables['n'][:], np.iinfo(np.int32).min)
+    assert np.all(n[~np.isnan(t)] == 7) and np.all(n[np.isnan(t)] == np.iinfo(np.int32).min)
+    ncfile.close()
+    ncsampled.close()